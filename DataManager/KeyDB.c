@@ -0,0 +1,125 @@
+/*
+ * KeyDB.c
+ *
+ * Description: Functions to access data objects by keys
+ */
+
+#include <DataManager/KeyDB.h>
+#include <FreeRTOS.h>
+#include <task.h>
+
+#pragma NOINIT(keyTable) //hash index of keys
+static struct keyEntry keyTable[KEYSLOTS];
+
+/* internal functions */
+static unsigned int hash(unsigned long key){
+    return (unsigned int)((key ^ (key >> 16)) * 40503u) % KEYSLOTS;
+}
+
+/*
+ * description: search the hash index for the key
+ * parameters: the key
+ * return: the index of the entry, or the empty entry to insert the key with its complement, -KEYSLOTS-1 for a full index
+ * */
+static int prvSearch(unsigned long key){
+    unsigned int i, h = hash(key);
+
+    for(i = 0; i < KEYSLOTS; i++, h = (h + 1) % KEYSLOTS){
+        if(keyTable[h].valid != 1)
+            return -(int)h - 1;
+        if(keyTable[h].key == key)
+            return h;
+    }
+    return -KEYSLOTS - 1;
+}
+
+/*
+ * description: reset the hash index
+ * parameters: none
+ * return: none
+ * note: should be called once with constructor()
+ * */
+void initKeys(){
+    int i;
+    for(i = 0; i < KEYSLOTS; i++){
+        keyTable[i].valid = 0;
+        keyTable[i].key = 0;
+    }
+}
+
+/*
+ * description: get the id of a key
+ * parameters: the key
+ * return: the id of the data, -1 for a missing key
+ * */
+int DBkey(unsigned long key){
+    int i = prvSearch(key);
+
+    if(i < 0)
+        return -1;
+    return keyTable[i].id;
+}
+
+/*
+ * description: create/write the data object of a key
+ * parameters: the key(0 is reserved), working space of the data, size in terms of bytes
+ * return: the id of the data, -1 for failure
+ * note: a new key is bound to a reserved id which is created by its first commit, DBget returns NULL before that
+ * */
+int DBput(unsigned long key, struct working *work, int size){
+    int i, id;
+
+    if(key == 0)
+        return -1;
+
+    DBENTER_CRITICAL();
+    i = prvSearch(key);
+    if(i >= 0)
+        id = keyTable[i].id;
+    else if(i == -KEYSLOTS - 1 || (id = DBreserve()) < 0){
+        DBEXIT_CRITICAL();
+        return -1;
+    }
+    else{
+        //the entry becomes valid after the key and id are written
+        i = -i - 1;
+        keyTable[i].key = key;
+        keyTable[i].id = id;
+        keyTable[i].valid = 1;
+    }
+    DBEXIT_CRITICAL();
+
+    work->id = id;
+    return DBcommit(work, size, 1);
+}
+
+/*
+ * description: return the address of the data object of a key
+ * parameters: the key
+ * return: the pointer of data, NULL for a missing key
+ * */
+void* DBget(unsigned long key){
+    int id = DBkey(key);
+
+    if(id < 0)
+        return NULL;
+    return DBread(id);
+}
+
+/*
+ * description: read the data object of a key
+ * parameters: read to where, the key
+ * return: the id of the data, -1 for a missing key
+ * */
+int DBgetIn(void* to, unsigned long key){
+    return DBreadIn(to, DBkey(key));
+}
+
+/*
+ * description: return a working space for the data object of a key
+ * parameters: data structure of working space, the key
+ * return: none
+ * */
+void DBworkingKey(struct working* wIn, unsigned long key){
+    DBworking(wIn, DBkey(key));
+}
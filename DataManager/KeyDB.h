@@ -0,0 +1,31 @@
+/*
+ * KeyDB.h
+ *
+ *  Description: Key-addressed data objects on top of SimpDB
+ *              ** A persistent open-addressing hash index in FRAM maps a key to the id of its data object
+ *              ** An entry is bound to a reserved id before the first commit of the object, so the key and
+ *                 the object become visible together and no id needs to be kept by applications
+ */
+
+#ifndef DATAMANAGER_KEYDB_H_
+#define DATAMANAGER_KEYDB_H_
+
+#include <DataManager/SimpDB.h>
+
+#define KEYSLOTS (2*NUMOBJ) //load factor no more than 0.5
+
+struct keyEntry{
+    unsigned long key;//0 for an empty entry
+    int id;
+    int valid;//1: key and id are written, set last
+};
+
+/* Functions to access data objects by keys */
+void initKeys();
+int DBkey(unsigned long key);
+int DBput(unsigned long key, struct working *work, int size);
+void* DBget(unsigned long key);
+int DBgetIn(void* to, unsigned long key);
+void DBworkingKey(struct working* wIn, unsigned long key);
+
+#endif /* DATAMANAGER_KEYDB_H_ */
@@ -0,0 +1,190 @@
+/*
+ * LogDB.c
+ *
+ * Description: Functions to append and read log objects
+ */
+
+#include <DataManager/LogDB.h>
+#include <Tools/dmacopy.h>
+#include <FreeRTOS.h>
+#include <task.h>
+
+#pragma NOINIT(LogSpace) //records of all logs, each one starts with its size
+static uint8_t LogSpace[MAXLOG][LOGSIZE];
+
+#pragma DATA_SECTION(logTail, ".map") //end of the published records of each log
+static unsigned int logTail[MAXLOG];
+
+//logs being appended or cleared, one bit for each log
+static unsigned int logLock;
+
+/* appends of each task slot in its current run, a rerun of the run skips the records published by its previous attempts */
+struct appendRecord{
+    unsigned int run;//run of the task slot, see getRunGen
+    unsigned int done;//appends published in the run
+    int log;//log of the append being published, -1 for none
+    unsigned int tail;//tail published by the append
+    unsigned int count;//number of the append in the run
+};
+#pragma NOINIT(Appends)
+static struct appendRecord Appends[NUMTASK];
+static unsigned int appendCalls[NUMTASK];//appends of the current attempt of the run
+static unsigned char appendRegister[NUMTASK];//registration of the attempt, see getRegisterGen
+
+/*
+ * description: reset all logs
+ * parameters: none
+ * return: none
+ * note: should be called once with constructor()
+ * */
+void initLogs(){
+    int i;
+    for(i = 0; i < MAXLOG; i++)
+        logTail[i] = 0;
+    for(i = 0; i < NUMTASK; i++){
+        Appends[i].run = getRunGen(i);
+        Appends[i].done = 0;
+        Appends[i].log = -1;
+    }
+    logLock = 0;
+}
+
+/*
+ * description: count the appends cut by a power failure after their tails were published
+ * parameters: none
+ * return: none
+ * note: should be called after power failures before any task runs, so the tails are only moved by the cut appends.
+ *       It can be cut and called again.
+ * */
+void recoverLogs(){
+    int i;
+    struct appendRecord* a;
+
+    for(i = 0; i < NUMTASK; i++){
+        a = &Appends[i];
+        if(a->log < 0)
+            continue;
+        if(logTail[a->log] == a->tail)
+            a->done = a->count;
+        a->log = -1;
+    }
+}
+
+/*
+ * description: lock a log for an append or a clear
+ * parameters: id of the log
+ * return: none
+ * */
+static void prvLockLog(int log){
+    while(1){
+        DBENTER_CRITICAL();
+        if(CHECK_BIT(logLock, log) == 0)
+            break;
+        DBEXIT_CRITICAL();
+        vTaskDelay(1);
+    }
+    logLock |= 1 << log;
+    DBEXIT_CRITICAL();
+}
+
+/*
+ * description: append a record to a log
+ * parameters: id of the log, the record, size of the record in bytes
+ * return: the id of the log, -1 for failure or a full log
+ * note: the record is visible once the function returns. Appends are numbered in the run of the task, the appends of a rerun
+ *       that have been published by its previous attempts are skipped, so a rerun task appends the same records once.
+ *       A run ends when the task registers again or unregisters, a new task in the slot should register before it appends.
+ * */
+int DBappend(int log, const void* record, unsigned int size){
+    int slot = getTaskID();
+    struct appendRecord* a = &Appends[slot];
+    unsigned int tail, next, call;
+
+    if(log < 0 || log >= MAXLOG || size == 0)
+        return -1;
+
+    /* number the append in the run, the attempts of a run are told apart by their registrations */
+    if(appendRegister[slot] != getRegisterGen(slot)){
+        appendRegister[slot] = getRegisterGen(slot);
+        appendCalls[slot] = 0;
+    }
+    call = ++appendCalls[slot];
+    if(a->run != getRunGen(slot)){//the first append of the run
+        a->done = 0;
+        a->run = getRunGen(slot);
+    }
+    if(call <= a->done)//published by a previous attempt
+        return log;
+
+    /* lock the log, the appender owns the space after the tail until it publishes the record */
+    prvLockLog(log);
+
+    tail = logTail[log];
+    next = tail + sizeof(unsigned int) + ((size + 1) & ~1);//keep records word aligned
+    if(next > LOGSIZE || next < tail){
+        DBENTER_CRITICAL();
+        logLock &= ~(1 << log);
+        DBEXIT_CRITICAL();
+        return -1;
+    }
+
+    /* write the record after the tail, it is invisible until the tail moves */
+    *(unsigned int*)&LogSpace[log][tail] = size;
+    DMAcopy(&LogSpace[log][tail + sizeof(unsigned int)], record, size);
+
+    /* publish the record by a single word write, the append is recorded first so that recoverLogs counts it if the power fails after the write */
+    a->tail = next;
+    a->count = call;
+    a->log = log;
+    DBENTER_CRITICAL();
+    logTail[log] = next;
+    a->done = call;
+    a->log = -1;
+    logLock &= ~(1 << log);
+    DBEXIT_CRITICAL();
+
+    return log;
+}
+
+/*
+ * description: drop all records of a log
+ * parameters: id of the log
+ * return: none
+ * note: iterators started before the clear should not be used anymore, an append in progress finishes before the clear
+ * */
+void DBlogClear(int log){
+    if(log < 0 || log >= MAXLOG)
+        return;
+    prvLockLog(log);
+    DBENTER_CRITICAL();
+    logTail[log] = 0;
+    logLock &= ~(1 << log);
+    DBEXIT_CRITICAL();
+}
+
+/*
+ * description: start to iterate the records of a log published so far
+ * parameters: the iterator, id of the log
+ * return: none
+ * */
+void DBlogBegin(struct logIter* it, int log){
+    it->log = log;
+    it->cursor = 0;
+    it->tail = (log >= 0 && log < MAXLOG)? logTail[log] : 0;
+}
+
+/*
+ * description: get the next record of an iterator
+ * parameters: the iterator, pointer to the record in FRAM
+ * return: size of the record, -1 at the end
+ * */
+int DBlogNext(struct logIter* it, const void** record){
+    unsigned int size;
+
+    if(it->cursor >= it->tail)
+        return -1;
+    size = *(unsigned int*)&LogSpace[it->log][it->cursor];
+    *record = &LogSpace[it->log][it->cursor + sizeof(unsigned int)];
+    it->cursor += sizeof(unsigned int) + ((size + 1) & ~1);
+    return size;
+}
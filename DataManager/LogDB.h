@@ -0,0 +1,30 @@
+/*
+ * LogDB.h
+ *
+ *  Description: Append-only log objects for data streams
+ *              ** Records are appended after the tail of a log in FRAM, then published by a single word write of the tail
+ *              ** A power failure before the tail is written leaves the log as it was, the records need no recovery
+ *              ** Appends are counted in the run of each task, so a rerun task does not append the same records again
+ *              ** Readers iterate the records before the tail they see, which is always a consistent prefix
+ */
+
+#ifndef DATAMANAGER_LOGDB_H_
+#define DATAMANAGER_LOGDB_H_
+
+#include <DataManager/SimpDB.h>
+
+struct logIter{//iterator of the records of a log
+    int log;
+    unsigned int cursor;//offset of the next record
+    unsigned int tail;//tail seen by the iterator
+};
+
+/* Functions to access log objects */
+void initLogs();
+void recoverLogs();
+int DBappend(int log, const void* record, unsigned int size);
+void DBlogClear(int log);
+void DBlogBegin(struct logIter* it, int log);
+int DBlogNext(struct logIter* it, const void** record);
+
+#endif /* DATAMANAGER_LOGDB_H_ */
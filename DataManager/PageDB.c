@@ -0,0 +1,134 @@
+/*
+ * PageDB.c
+ *
+ * Description: Functions to create, read and write slices of paged array objects
+ */
+
+#include <DataManager/PageDB.h>
+#include <Tools/dmacopy.h>
+#include <FreeRTOS.h>
+#include <task.h>
+
+#define PAGES(size) (((size) + PAGESIZE - 1) / PAGESIZE)
+#define PAGEBYTES(table, p) (((unsigned int)(p) + 1 < PAGES((table)->size))? PAGESIZE : (table)->size - (p) * PAGESIZE)
+
+/*
+ * description: create a paged array object, the pages are committed before the page table which publishes the array
+ * parameters: initial content of the array, size of the array in bytes
+ * return: the id of the array, -1 for failure
+ * note: the pages created before a failed commit are deleted, but their ids are lost if a power failure happens before
+ *       the page table is committed, like DBreserve
+ * */
+int DBarrayCreate(const void* from, unsigned int size){
+    struct pageTable table;
+    struct working work[MAXCOMMIT];
+    int p, k, id, pages = PAGES(size);
+
+    if(size == 0 || pages > MAXPAGES)
+        return -1;
+
+    //pages are not reachable until the page table is committed, so they are committed in as many DBcommit as needed
+    table.size = size;
+    for(p = 0; p < pages; p += k){
+        for(k = 0; k < MAXCOMMIT && p + k < pages; k++){
+            work[k].address = (uint8_t*)from + (p + k) * PAGESIZE;
+            work[k].id = -1;
+            work[k].size = PAGEBYTES(&table, p + k);
+            work[k].loc = LOCNVM;
+        }
+        id = DBcommit(work, 0, k);
+        for(k = 0; k < MAXCOMMIT && p + k < pages; k++)
+            table.page[p + k] = work[k].id;//the ids taken by a failed commit are given back too
+        if(id < 0){
+            DBdelete(table.page, p + k);
+            return -1;
+        }
+    }
+    for(; p < MAXPAGES; p++)
+        table.page[p] = -1;
+
+    work[0].address = &table;
+    work[0].id = -1;
+    work[0].size = sizeof(struct pageTable);
+    work[0].loc = LOCVM;
+    id = DBcommit(work, 0, 1);
+    if(id < 0){
+        DBdelete(&work[0].id, 1);//given back before the pages, the last id given out
+        DBdelete(table.page, pages);
+    }
+    return id;
+}
+
+/*
+ * description: read a slice of a paged array object
+ * parameters: id of the array, read to where, offset and length of the slice in bytes
+ * return: the id of the array, -1 for failure
+ * note: the page table and the pages are read by DBread, so the slice is validated at the next DBcommit of the task
+ * */
+int DBreadRange(int id, void* to, unsigned int offset, unsigned int len){
+    const struct pageTable* table = DBread(id);
+    const uint8_t* page;
+    unsigned int p, begin, bytes;
+
+    if(table == NULL || offset > table->size || len > table->size - offset)
+        return -1;
+
+    for(p = offset / PAGESIZE; len > 0; p++){
+        page = DBread(table->page[p]);
+        if(page == NULL)
+            return -1;
+        begin = offset - p * PAGESIZE;
+        bytes = min(len, PAGEBYTES(table, p) - begin);
+        DMAcopy(to, (void*)(page + begin), bytes);
+        to = (uint8_t*)to + bytes;
+        offset += bytes;
+        len -= bytes;
+    }
+
+    return id;
+}
+
+/*
+ * description: write a slice of a paged array object, only the pages it touches are copied to new versions
+ * parameters: id of the array, new content of the slice, offset and length of the slice in bytes
+ * return: the id of the array, -1 for failure or a slice over more than MAXCOMMIT pages
+ * note: a page written partly is read and merged in a working space of the task, a page written fully is
+ *       committed from the new content directly. The commit is validated like DBcommit.
+ * */
+int DBwriteRange(int id, const void* from, unsigned int offset, unsigned int len){
+    const struct pageTable* table = DBread(id);
+    const uint8_t* page;
+    struct working work[MAXCOMMIT];
+    unsigned int p, begin, bytes, size;
+    int k;
+
+    if(table == NULL || len == 0 || offset > table->size || len > table->size - offset)
+        return -1;
+    if((offset + len - 1) / PAGESIZE - offset / PAGESIZE >= MAXCOMMIT)
+        return -1;
+
+    for(k = 0, p = offset / PAGESIZE; len > 0; k++, p++){
+        begin = offset - p * PAGESIZE;
+        size = PAGEBYTES(table, p);
+        bytes = min(len, size - begin);
+        if(bytes == size){
+            work[k].address = (void*)from;
+            work[k].id = table->page[p];
+            work[k].size = size;
+            work[k].loc = LOCVM;
+        }
+        else{
+            page = DBread(table->page[p]);
+            DBworkingSize(&work[k], table->page[p], size, LOCVM);
+            if(page == NULL || work[k].address == NULL)
+                return -1;
+            DMAcopy(work[k].address, (void*)page, size);
+            DMAcopy((uint8_t*)work[k].address + begin, (void*)from, bytes);
+        }
+        from = (const uint8_t*)from + bytes;
+        offset += bytes;
+        len -= bytes;
+    }
+
+    return (DBcommit(work, 0, k) < 0)? -1 : id;
+}
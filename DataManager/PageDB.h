@@ -0,0 +1,25 @@
+/*
+ * PageDB.h
+ *
+ *  Description: Paged array objects for large arrays updated a few elements at a time
+ *              ** An array is a data object holding a page table, and each page is a data object of PAGESIZE bytes
+ *              ** A slice write commits only the pages it touches, the other pages are shared by the versions of the array
+ *              ** The touched pages are committed by a single DBcommit, so a slice write is atomic and validated as usual
+ */
+
+#ifndef DATAMANAGER_PAGEDB_H_
+#define DATAMANAGER_PAGEDB_H_
+
+#include <DataManager/SimpDB.h>
+
+struct pageTable{//content of a paged array object
+    unsigned int size;//bytes of the array
+    int page[MAXPAGES];//ids of the pages
+};
+
+/* Functions to access paged array objects */
+int DBarrayCreate(const void* from, unsigned int size);
+int DBreadRange(int id, void* to, unsigned int offset, unsigned int len);
+int DBwriteRange(int id, const void* from, unsigned int offset, unsigned int len);
+
+#endif /* DATAMANAGER_PAGEDB_H_ */
@@ -7,8 +7,13 @@
 
 #include <DataManager/SimpDB.h>
 #include <RecoveryHandler/Recovery.h>
+#include <DataManager/slab.h>
+#include <Tools/dmacopy.h>
+#include <Tools/checksum.h>
+#include <TaskManager/taskManager.h>
 #include <FreeRTOS.h>
 #include <stdio.h>
+#include <string.h>
 #include <task.h>
 #include <config.h>
 
@@ -107,8 +112,14 @@ typedef struct tskTaskControlBlock
 
 } tskTCB;
 
-//Space for working versions at SRAM
-static long Working[NUMTASK][NUMOBJ+1];
+//Space for working versions at SRAM, each task allocates its working spaces from its own arena until it commits
+static uint8_t WorkingVM[NUMTASK][WORKSRAMSIZE];
+static unsigned int WorkingVMIndex[NUMTASK];
+//Space for working versions at FRAM, used for the working spaces too large for SRAM
+#pragma NOINIT(WorkingNVM)
+static uint8_t WorkingNVM[NUMTASK][WORKNVMSIZE];
+#pragma NOINIT(WorkingNVMIndex)//kept with the arena, so a resumed lengthy task does not reuse its working spaces
+static unsigned int WorkingNVMIndex[NUMTASK];
 
 /* stacks allocated for tasks */
 #pragma location = 0x1C00 //Space for working at SRAM
@@ -117,6 +128,289 @@ static unsigned char TCBVM[sizeof( tskTCB )*NUMTASK];
 
 extern tskTCB * volatile pxCurrentTCB;
 
+#pragma NOINIT(DBSpace) //space for maintaining data structure of data
+static uint8_t DBSpace[TOTAL_DATA_SIZE];
+
+#pragma NOINIT(DB) //data structures for all data
+static struct data* DB;
+
+#pragma DATA_SECTION(dataId, ".map") //id for data labeling
+static int dataId;
+
+// used for validation, indexed by task slot (taskID): the task in slot i with Task's TCB = WSRTCB[i], WSRBegin[i] = min(writer's begin), WSRValid[i] = 1
+static unsigned long WSRBegin[NUMTASK]; //The "begin time of every commit operation" for an object "read by task i" is saved in WSRBegin[i]
+static unsigned short WSRTCB[NUMTASK];
+static unsigned char WSRValid[NUMTASK];
+static unsigned char WSRGen[NUMTASK];//generation of the registration in slot i, bumped by every registerTCB
+
+/* internal functions */
+unsigned long min(unsigned long a, unsigned long b){
+    if (a > b)
+        return b;
+    else
+        return a;
+}
+
+#ifdef DBSLAB
+/* versions allocated and replaced by the running commit of each task slot, so DBrecovery reclaims them without scanning */
+struct versionIntent{
+    int num;
+    int id[MAXCOMMIT];
+    void* address[MAXCOMMIT];//new version, NULL after it is linked by the maps
+    void* previous[MAXCOMMIT];//replaced version, NULL after it is freed
+};
+#pragma NOINIT(Intents)
+static struct versionIntent Intents[NUMTASK];
+#endif
+
+#ifdef DBCOMPACT
+#if defined(SHADOWSLOT) || NUMVERSION > 2
+#error "DBCOMPACT relocates the only live version of an object, which is not the case with SHADOWSLOT or NUMVERSION > 2"
+#endif
+enum{
+    COMPACTIDLE = 0,
+    COMPACTMOVING
+};
+
+/* version being relocated by DBcompact */
+struct compactRecord{
+    int state;
+    int id;
+    void* from;
+    void* to;
+};
+#pragma NOINIT(Compaction) //kept in FRAM, so DBrecovery frees either the old or the new copy after power failures
+static struct compactRecord Compaction;
+static int compactCursor;//next object to be examined
+#endif
+
+#ifdef DBRESUME
+#ifdef SHADOWSLOT
+#error "DBRESUME copies to a new version, which is not the case with SHADOWSLOT"
+#endif
+enum{
+    RESUMEFREE = 0,
+    RESUMECOPY,//validated, the version is being copied up to the cursor
+    RESUMEPUBLISHED//linked, the replaced version is to be freed
+};
+
+/* large commits of DBcommitLarge, one for each task slot, decided at validation and finished even after power failures */
+struct resumableCommit{
+    int state;
+    int id;
+    unsigned int run;//run of the task slot, see getRunGen
+    unsigned int calls;//commits called by the current attempt of the run, reset by registerTCB but kept by a resumed task
+    unsigned int call;//number of the commit in the run
+    unsigned int done;//commits finished in the run, a rerun returns them instead of copying again
+    int ids[RESUMECALLS];//ids of the first commits finished in the run, indexed by their number
+    unsigned int size;
+    unsigned int cursor;//bytes copied to the version
+    const void* from;//source in FRAM
+    void* version;
+    void* previous;
+    unsigned long vBegin;
+    unsigned long vEnd;
+};
+#pragma NOINIT(Resumes)
+static struct resumableCommit Resumes[NUMTASK];
+#endif
+
+#ifdef UNDOLOG
+#if defined(SHADOWSLOT) || defined(GROUPCOMMIT) || NUMVERSION > 2
+#error "UNDOLOG overwrites the only live version of an object, which is not the case with SHADOWSLOT, GROUPCOMMIT or NUMVERSION > 2"
+#endif
+
+/* versions overwritten by the in-place commit of a task, restored by DBrecovery if the commit is cut by a power failure */
+struct undoLog{
+    int num;//records, published after their data, 0 when no in-place commit is in progress
+    int id[MAXCOMMIT];
+    unsigned int size[MAXCOMMIT];
+    unsigned int offset[MAXCOMMIT];//offset of the previous version in the space
+    unsigned long vBegin[MAXCOMMIT];
+    unsigned long vEnd[MAXCOMMIT];
+    unsigned long time[MAXCOMMIT];
+    uint8_t space[UNDOSIZE];
+};
+#pragma NOINIT(Undo)
+static struct undoLog Undo[NUMTASK];
+static unsigned int inPlaceObj[SWITCHERWORDS];//objects being overwritten, their readers wait, one bit for each object
+#endif
+
+#ifdef DBCACHE
+#if defined(SHADOWSLOT) || defined(GROUPCOMMIT) || defined(UNDOLOG) || NUMVERSION > 2
+#error "DBCACHE writes back to the only live version of an object, which is not the case with SHADOWSLOT, GROUPCOMMIT, UNDOLOG or NUMVERSION > 2"
+#endif
+#if CACHEENTRIES > MAXCOMMIT
+#error "the cached objects are written back by a single switch, CACHEENTRIES cannot exceed MAXCOMMIT"
+#endif
+
+/* SRAM copies of the most read objects, an entry is valid while DB[id].cacheAdd points to its copy */
+struct cacheEntry{
+    int id;//-1 for a free entry
+    unsigned int offset;//offset of the copy in CacheSpace
+    unsigned int size;
+    unsigned char dirty;//committed but not written back
+    unsigned int gen;//bumped by every cached commit, a write-back staged from an older copy is not published
+};
+static uint8_t CacheSpace[CACHESIZE];
+static struct cacheEntry Cache[CACHEENTRIES];
+static unsigned char cacheHits[NUMOBJ];//reads of each object since the last aging
+static unsigned int cacheReads;//reads since the last aging
+static unsigned char cacheBusy;//one task admits an object or stages the write-back at a time
+static unsigned char cacheWriteThrough;//set at low voltage, commits are not cached until the voltage is high again
+#pragma NOINIT(cacheShadow) //FRAM versions preallocated for the write-back, so DBcacheFlush does not allocate in interrupts
+static void* cacheShadow[NUMOBJ];
+#pragma NOINIT(cacheStage) //FRAM versions preallocated for the write-back staged by tasks, never the shadow used by DBcacheFlush
+static void* cacheStage[NUMOBJ];
+
+/* write-back copied by a task outside critical sections, published by prvCacheWriteBack if the copies have not changed */
+struct cacheStaging{
+    int num;
+    int entry[CACHEENTRIES];
+    int id[CACHEENTRIES];
+    unsigned int gen[CACHEENTRIES];
+};
+#endif
+
+#ifdef DBCRC
+#pragma NOINIT(DBcrcFailures) //corrupted versions found by DBrecovery
+unsigned long DBcrcFailures;
+
+/* the objects of the latest commits, verified after power failures */
+#pragma NOINIT(recentCommit)
+static int recentCommit[CRCRECENT];
+#pragma DATA_SECTION(recentNext, ".map")
+static int recentNext;
+#endif
+
+//tasks found unable to commit by DBtickValidate, indexed by task slot
+static unsigned char Doomed[NUMTASK];
+
+#if defined(UNDOLOG) || defined(DBCACHE)
+//tasks holding a pointer returned by DBread, which is overwritten by the next in-place commit of the data, indexed by task slot
+static unsigned char HoldsPointer[NUMTASK];
+#endif
+
+//tasks declared read-only by DBreadOnly, their snapshot time and whether the snapshot has been read, indexed by task slot
+static unsigned char ReadOnly[NUMTASK];
+static unsigned char ReadOnlyRead[NUMTASK];
+static unsigned long ReadOnlyTime[NUMTASK];
+
+//tasks in a transaction of DBtx*, whose failed validation is returned instead of rerunning the task, indexed by task slot
+static unsigned char InTx[NUMTASK];
+
+//runs finished by each task slot, a run ends when its TCB registers again or unregisters, so reruns keep the run
+#pragma NOINIT(RunGen)
+static unsigned int RunGen[NUMTASK];
+
+//objects being committed, one bit for each object
+static unsigned int commitLock[SWITCHERWORDS];
+
+#if defined(DBCOALESCE) && !defined(GROUPCOMMIT)
+#error "DBCOALESCE rewrites the versions staged by GROUPCOMMIT"
+#endif
+
+#ifdef GROUPCOMMIT
+enum{
+    STAGEFREE = 0,
+    STAGED,//validated, waiting for DBpublish
+    STAGEREWRITE,//the versions are rewritten by a coalesced commit of the task, not published until it is STAGED again
+    PUBLISHED//the replaced versions are to be freed by the task
+};
+
+/* commits validated but not published yet, one for each task slot */
+struct stagedCommit{
+    int state;
+    int num;
+    int id[MAXCOMMIT];
+    unsigned int size[MAXCOMMIT];
+    void* address[MAXCOMMIT];
+    void* previous[MAXCOMMIT];
+    unsigned long vBegin;
+    unsigned long vEnd;
+};
+#pragma NOINIT(Staged) //kept in FRAM, so the versions of unpublished commits can be reclaimed after power failures
+static struct stagedCommit Staged[NUMTASK];
+static unsigned int stagedObj[SWITCHERWORDS];//objects with a staged version, one bit for each object
+static unsigned long stagedBegin[NUMOBJ];//begin of the valid interval of the staged version
+
+/* the batch being published */
+static int batchId[NUMOBJ];
+static void* batchAddress[NUMOBJ];
+static unsigned long batchBegin[NUMOBJ];
+static unsigned long batchEnd[NUMOBJ];
+#endif
+
+//versions pinned by read leases, a version replaced while it is leased is freed by its last lease.
+//The first MAXLEASE entries are shared by DBleaseBegin, then each task slot has MAXSNAPSHOT entries for its snapshot reads
+#define LEASEENTRIES (MAXLEASE + NUMTASK*MAXSNAPSHOT)
+#define SNAPSHOTPINS(slot) (MAXLEASE + (slot)*MAXSNAPSHOT)
+struct lease{
+    const void* address;//NULL for a free entry
+    int id;
+    int slot;//task slot of the holder
+    int deferred;//1 if the version has been replaced and should be freed at the end of the lease
+};
+#pragma NOINIT(Leases)
+static struct lease Leases[LEASEENTRIES];
+
+#ifdef DBPROFILE
+/* time with interrupts disabled in the data manager, in SMCLK cycles */
+unsigned int criticalStart;
+unsigned int criticalDepth;//nesting of the critical sections, only the outermost one is timed
+#pragma NOINIT(DBcriticalCycles)
+unsigned long DBcriticalCycles;
+#pragma NOINIT(DBcriticalCount)
+unsigned long DBcriticalCount;
+#pragma NOINIT(DBcriticalMax)
+unsigned int DBcriticalMax;
+/* outcome of the validation of DBcommit, for the abort rate */
+#pragma NOINIT(DBcommitCount)
+unsigned long DBcommitCount;
+#pragma NOINIT(DBabortCount)
+unsigned long DBabortCount;
+#pragma NOINIT(DBearlyAbortCount)
+unsigned long DBearlyAbortCount;//aborts before DBcommit, included in DBabortCount
+#pragma NOINIT(DBbatchCount)
+unsigned long DBbatchCount;//batches published by DBpublish, DBcommitCount/DBbatchCount commits share a switch
+/* cost of DBCRC: cycles computing the CRC32 of new versions, and the verification of DBrecovery */
+#pragma NOINIT(DBcrcCycles)
+unsigned long DBcrcCycles;
+#pragma NOINIT(DBverifyCycles)
+unsigned long DBverifyCycles;
+#pragma NOINIT(DBverifyBytes)
+unsigned long DBverifyBytes;
+/* FRAM bytes of the new versions written by DBcommit, and the commits saved by DBELIDE and DBCOALESCE */
+#pragma NOINIT(DBwriteBytes)
+unsigned long DBwriteBytes;
+#pragma NOINIT(DBelideCount)
+unsigned long DBelideCount;//entries not written as they equal their committed versions
+#pragma NOINIT(DBcoalesceCount)
+unsigned long DBcoalesceCount;//commits which rewrite the unpublished versions of the task
+/* reads served by the SRAM copies of DBCACHE, and the write-backs of the cached commits */
+#pragma NOINIT(DBcacheHits)
+unsigned long DBcacheHits;
+#pragma NOINIT(DBcacheMisses)
+unsigned long DBcacheMisses;
+#pragma NOINIT(DBflushCount)
+unsigned long DBflushCount;
+
+/*
+ * description: accumulate the length of the critical section started at criticalStart
+ * parameters: none
+ * return: none
+ * note: called when the outermost critical section ends, right before interrupts are enabled again, Timer B0 wraps every 65536 cycles
+ * */
+void DBprofileCritical(){
+    unsigned int cycles = TB0R - criticalStart;
+
+    DBcriticalCycles += cycles;
+    DBcriticalCount++;
+    if(cycles > DBcriticalMax)
+        DBcriticalMax = cycles;
+}
+#endif
+
 
 /*
  * description: initialize all data structure in the database
@@ -130,150 +424,2130 @@ void constructor(){
     for(i = 0; i < NUMOBJ; i++){
         DB[i].cacheAdd = NULL;
         DB[i].size = 0;
-        for(j = 0; j <MAXREAD; j++)
-            DB[i].readTCBNum[j] = 0;
+        DB[i].capacity = 0;
+        for(j = 0; j < READERWORDS; j++)
+            DB[i].readers[j] = 0;
+        for(j = 0; j < NUMTASK; j++)
+            DB[i].readGen[j] = 0;
+    }
+    dataId = 0;
+    for(i = 0; i < NUMTASK; i++)
+        WorkingNVMIndex[i] = 0;
+    for(i = 0; i < LEASEENTRIES; i++)
+        Leases[i].address = NULL;
+#ifdef GROUPCOMMIT
+    for(i = 0; i < NUMTASK; i++)
+        Staged[i].state = STAGEFREE;
+#endif
+#ifdef DBSLAB
+    for(i = 0; i < NUMTASK; i++)
+        Intents[i].num = 0;
+#endif
+#ifdef UNDOLOG
+    for(i = 0; i < NUMTASK; i++)
+        Undo[i].num = 0;
+#endif
+#ifdef DBCACHE
+    for(i = 0; i < NUMOBJ; i++){
+        cacheShadow[i] = NULL;
+        cacheStage[i] = NULL;
+    }
+#endif
+#ifdef DBRESUME
+    for(i = 0; i < NUMTASK; i++){
+        Resumes[i].state = RESUMEFREE;
+        Resumes[i].version = NULL;
+        Resumes[i].run = 0;
+        Resumes[i].calls = 0;
+        Resumes[i].done = 0;
+    }
+#endif
+#ifdef DBCOMPACT
+    Compaction.state = COMPACTIDLE;
+#endif
+#ifdef DBCRC
+    DBcrcFailures = 0;
+    recentNext = 0;
+    for(i = 0; i < CRCRECENT; i++)
+        recentCommit[i] = -1;
+#endif
+
+    for(i = 0; i < NUMTASK; i++){
+        WSRValid[i] = 0;
+        WSRGen[i] = 0;
+        RunGen[i] = 0;
+    }
+
+#ifdef DBPROFILE
+    DBcriticalCycles = 0;
+    DBcriticalCount = 0;
+    DBcriticalMax = 0;
+    DBcommitCount = 0;
+    DBabortCount = 0;
+    DBearlyAbortCount = 0;
+    DBbatchCount = 0;
+    DBcrcCycles = 0;
+    DBverifyCycles = 0;
+    DBverifyBytes = 0;
+    DBwriteBytes = 0;
+    DBelideCount = 0;
+    DBcoalesceCount = 0;
+    DBcacheHits = 0;
+    DBcacheMisses = 0;
+    DBflushCount = 0;
+#endif
+}
+
+#ifdef DBCRC
+/*
+ * description: write the CRC32 after the data of a new version
+ * parameters: the version, size of the data
+ * return: none
+ * */
+static void prvSeal(void* version, unsigned int size){
+#ifdef DBPROFILE
+    unsigned int start = TB0R;
+#endif
+    *(uint32_t*)((uint8_t*)version + CRCOFFSET(size)) = checksum(version, size);
+#ifdef DBPROFILE
+    DBcrcCycles += (unsigned int)(TB0R - start);
+#endif
+}
+
+/*
+ * description: check the CRC32 of the consistent version of the data
+ * parameters: id of the data
+ * return: 1 if the data matches its CRC32, 0 otherwise
+ * */
+static int prvVerify(int id){
+    uint8_t* version = accessData(id);
+    int match;
+#ifdef DBPROFILE
+    unsigned int start = TB0R;
+#endif
+
+    match = (version != NULL && *(uint32_t*)(version + CRCOFFSET(DB[id].size)) == checksum(version, DB[id].size));
+#ifdef DBPROFILE
+    DBverifyCycles += (unsigned int)(TB0R - start);
+    DBverifyBytes += DB[id].size;
+#endif
+    return match;
+}
+
+/*
+ * description: record a committed object to be verified after power failures
+ * parameters: id of the data
+ * return: none
+ * note: should be called in critical sections
+ * */
+static void prvRecent(int id){
+    recentCommit[recentNext] = id;
+    recentNext = (recentNext + 1) % CRCRECENT;
+}
+#endif
+
+#if defined(DBSLAB) || defined(GROUPCOMMIT) || defined(DBRESUME) || defined(DBCACHE)
+/*
+ * description: free a recorded version unless the power failure hit after it had been freed
+ * parameters: record of the version
+ * return: none
+ * */
+static void prvReclaim(void** record){
+    if(DBfreed(*record))
+        *record = NULL;
+    DBfree(record);
+}
+#endif
+
+#ifdef DBRESUME
+/*
+ * description: copy the rest of a large commit from its cursor, then link it by the atomic switch of the maps
+ * parameters: the large commit
+ * return: none
+ * note: a chunk is copied again if a power failure hits before the cursor moves, the version is linked once.
+ *       The caller frees the replaced version and unlocks the object.
+ * */
+static void prvResumeCopy(struct resumableCommit* r){
+    unsigned int n;
+
+    if(r->version == NULL)//released already, nothing to publish
+        return;
+    while(r->cursor < r->size){
+        n = (r->size - r->cursor < RESUMECHUNK)? r->size - r->cursor : RESUMECHUNK;
+        DMAcopy((uint8_t*)r->version + r->cursor, (uint8_t*)r->from + r->cursor, n);
+        r->cursor += n;
+    }
+#ifdef DBCRC
+    prvSeal(r->version, r->size);
+#endif
+
+    DBENTER_CRITICAL();
+    if(accessData(r->id) != r->version)
+        commitGroup(1, &r->id, &r->version, r->vBegin, r->vEnd);
+    DB[r->id].size = r->size;
+    DB[r->id].cacheAdd = NULL;
+#ifdef DBCRC
+    prvRecent(r->id);
+#endif
+    if(r->call <= RESUMECALLS)
+        r->ids[r->call-1] = r->id;
+    r->done = r->call;
+    r->state = RESUMEPUBLISHED;
+    DBEXIT_CRITICAL();
+}
+#endif
+
+/*
+ * description: check if the task of a slot is resumed from where it stopped by failureRecovery, instead of rerun
+ * parameters: task slot
+ * return: 1 if the task is resumed, 0 otherwise
+ * note: a lengthy task can be stopped in the middle of a data manager call, which it continues after the power failure
+ * */
+static int prvResumed(int slot){
+    return getLocation(slot) == INNVM && getStatus(slot) == STOP;
+}
+
+#if defined(DBSLAB) || defined(GROUPCOMMIT) || defined(UNDOLOG) || defined(DBRESUME)
+/*
+ * description: lock the objects of a commit continued by a resumed task, as the locks in SRAM are lost by the power failure
+ * parameters: ids of the objects, number of the data
+ * return: none
+ * */
+static void prvRelockObjects(int* workId, int num){
+    int k;
+
+    for(k = 0; k < num; k++)
+        if(workId[k] >= 0 && workId[k] < NUMOBJ)
+            commitLock[workId[k]/16] |= 1 << (workId[k]%16);
+}
+#endif
+
+/*
+ * description: recover data structures of the data manager after power failure
+ * parameters: none
+ * return: none
+ * note: should be called before any task is recovered
+ * */
+void DBrecovery(){
+    int i, j, held;
+
+    recoverMaps();
+
+#ifdef UNDOLOG
+    //an in-place commit cut by a power failure is undone from the log of the task, the records are restored again if cut,
+    //a resumed task finishes its overwrite instead, its objects are locked again and their readers wait as before
+    for(i = 0; i < NUMTASK; i++){
+        if(prvResumed(i)){
+            prvRelockObjects(Undo[i].id, Undo[i].num);
+            for(j = 0; j < Undo[i].num; j++)
+                inPlaceObj[Undo[i].id[j]/16] |= 1 << (Undo[i].id[j]%16);
+            continue;
+        }
+        for(j = 0; j < Undo[i].num; j++){
+            DMAcopy(accessData(Undo[i].id[j]), &Undo[i].space[Undo[i].offset[j]], VERSIONSIZE(Undo[i].size[j]));
+            setValidity(Undo[i].id[j], Undo[i].vBegin[j], Undo[i].vEnd[j]);
+            setCommitTime(Undo[i].id[j], Undo[i].time[j]);
+        }
+        Undo[i].num = 0;
+    }
+#endif
+
+    //the rerun holders release their leases and the replaced versions pinned only by them are freed,
+    //a resumed task still reads its leased versions, which are freed by its last lease instead
+    for(i = 0; i < LEASEENTRIES; i++){
+        if(Leases[i].address == NULL || prvResumed(Leases[i].slot))
+            continue;
+        if(Leases[i].deferred){
+            held = 0;
+            for(j = 0; j < LEASEENTRIES; j++){
+                if(j == i || Leases[j].address != Leases[i].address)
+                    continue;
+                if(prvResumed(Leases[j].slot)){
+                    Leases[j].deferred = 1;
+                    held = 1;
+                }
+                else
+                    Leases[j].address = NULL;
+            }
+            if(held == 0)
+                DBfree((void**)&Leases[i].address);
+        }
+        Leases[i].address = NULL;
+    }
+
+#ifdef DBCOMPACT
+    //the relocated copy is kept if it has been linked, DBfree clears the record so no copy is freed twice
+    if(Compaction.state == COMPACTMOVING){
+        if(accessData(Compaction.id) == Compaction.to)
+            DBfree(&Compaction.from);
+        else
+            DBfree(&Compaction.to);
+        Compaction.to = NULL;
+        Compaction.from = NULL;
+        Compaction.state = COMPACTIDLE;
+    }
+#endif
+
+#ifdef DBSLAB
+    //versions of the commits in progress: a linked new version replaces the previous one, otherwise it is dropped.
+    //A resumed task continues its commit, so its versions are kept and its objects are locked again
+    for(i = 0; i < NUMTASK; i++){
+#ifdef GROUPCOMMIT
+        if(Staged[i].state != STAGEFREE)//handed over to the staged commit
+            Intents[i].num = 0;
+#endif
+        if(prvResumed(i)){
+            prvRelockObjects(Intents[i].id, Intents[i].num);
+            continue;
+        }
+        for(j = 0; j < Intents[i].num; j++){
+            if(Intents[i].address[j] != NULL){
+                if(accessData(Intents[i].id[j]) == Intents[i].address[j])
+                    Intents[i].address[j] = NULL;
+                else{
+                    prvReclaim(&Intents[i].address[j]);
+                    Intents[i].previous[j] = NULL;
+                }
+            }
+            prvReclaim(&Intents[i].previous[j]);
+        }
+        Intents[i].num = 0;
+    }
+#endif
+
+#ifdef GROUPCOMMIT
+    //a staged commit is published if its version is linked by the maps, otherwise its version is dropped.
+    //The versions of a published commit are not tested, as its objects are unlocked and may have been committed again
+    for(i = 0; i < NUMTASK; i++){
+        if(prvResumed(i)){
+            //a resumed task keeps its staged commit, which is published by DBpublish and retired by the task
+            if(Staged[i].state == STAGED && Staged[i].num > 0 && accessData(Staged[i].id[0]) == Staged[i].address[0]){
+                for(j = 0; j < Staged[i].num; j++)
+                    DB[Staged[i].id[j]].size = Staged[i].size[j];
+                Staged[i].state = PUBLISHED;
+            }
+            else if(Staged[i].state == STAGED || Staged[i].state == STAGEREWRITE){
+                prvRelockObjects(Staged[i].id, Staged[i].num);
+                for(j = 0; j < Staged[i].num; j++){
+                    stagedObj[Staged[i].id[j]/16] |= 1 << (Staged[i].id[j]%16);
+                    stagedBegin[Staged[i].id[j]] = Staged[i].vBegin;
+                }
+            }
+            continue;
+        }
+        if(Staged[i].state == PUBLISHED){
+#ifndef SHADOWSLOT
+            for(j = 0; j < Staged[i].num; j++)
+                prvReclaim(&Staged[i].previous[j]);
+#endif
+        }
+        else if(Staged[i].state != STAGEFREE){
+            for(j = 0; j < Staged[i].num; j++){
+                if(accessData(Staged[i].id[j]) == Staged[i].address[j]){
+                    DB[Staged[i].id[j]].size = Staged[i].size[j];
+#ifndef SHADOWSLOT
+                    prvReclaim(&Staged[i].previous[j]);
+                }
+                else
+                    prvReclaim(&Staged[i].address[j]);
+#else
+                }
+#endif
+            }
+        }
+        Staged[i].state = STAGEFREE;
+    }
+#endif
+
+#ifdef DBRESUME
+    //a validated large commit is finished from its cursor, its source is in FRAM and untouched until the task reruns,
+    //the rerun returns the finished commit instead of copying it again. A resumed task finishes its own commit
+    for(i = 0; i < NUMTASK; i++){
+        if(prvResumed(i)){
+            if(Resumes[i].state == RESUMECOPY)
+                prvRelockObjects(&Resumes[i].id, 1);
+            continue;
+        }
+        if(Resumes[i].state == RESUMECOPY)
+            prvResumeCopy(&Resumes[i]);
+        if(Resumes[i].state == RESUMEPUBLISHED)
+            prvReclaim(&Resumes[i].previous);
+        else
+            prvReclaim(&Resumes[i].version);//not validated yet
+        Resumes[i].version = NULL;
+        Resumes[i].state = RESUMEFREE;
+    }
+#endif
+
+#ifdef DBCACHE
+    //the SRAM copies are lost. A shadow or staged version linked by a write-back cut before it was swapped keeps its version,
+    //and the version it replaced is the one to be freed
+    for(i = 0; i < CACHEENTRIES; i++)
+        Cache[i].id = -1;
+    for(i = 0; i < NUMOBJ; i++){
+        DB[i].cacheAdd = NULL;
+        cacheHits[i] = 0;
+        if(cacheShadow[i] != NULL && accessData(i) == cacheShadow[i])
+            cacheShadow[i] = accessShadow(i);
+        prvReclaim(&cacheShadow[i]);
+        if(cacheStage[i] != NULL && accessData(i) == cacheStage[i])
+            cacheStage[i] = accessShadow(i);
+        prvReclaim(&cacheStage[i]);
+    }
+#endif
+
+#ifdef DBCRC
+    //only the latest commits are verified to keep the boot time bounded, a corrupted version is not readable anymore
+    for(i = 0; i < CRCRECENT; i++){
+        j = recentCommit[i];
+        if(j >= 0 && j < NUMOBJ && DB[j].size > 0 && prvVerify(j) == 0){
+            DB[j].size = 0;
+            DBcrcFailures++;
+        }
+    }
+#endif
+}
+
+/*
+ * description: free all allocated data, implemented for completeness and not used currently
+ * parameters: none
+ * return: none
+ * */
+void destructor(){
+    int i;
+    for(i = 0; i < NUMOBJ; i++){
+        if(DB[i].size > 0){
+#ifdef SHADOWSLOT
+            //all versions share one allocation
+            vPortFree(accessBase(i));
+#else
+            int v;
+            void* version;
+            for(v = 0; v < NUMVERSION && accessVersion(i, v) != NULL; v++){
+                version = accessVersion(i, v);
+                DBfree(&version);
+            }
+#endif
+        }
+    }
+}
+
+/*
+ * description: reduce the valid interval of the tasks that have read the data, then clear the readers
+ * parameters: id of the data, begin of the writer's valid interval
+ * return: none
+ * note: should be called in critical sections
+ * */
+static void prvInvalidateReaders(int id, unsigned long vBegin, int self){
+    int w, b;
+    unsigned int readers;
+
+    for(w = 0; w < READERWORDS; w++){
+        readers = DB[id].readers[w];
+        DB[id].readers[w] = 0;
+        for(b = w * 16; readers != 0; b++, readers >>= 1){
+            //no point to self-restricted
+            if((readers & 1) == 0 || b == self)
+                continue;
+            //only the current registration of the slot is restricted
+            if(WSRValid[b] == 1 && DB[id].readGen[b] == WSRGen[b])
+                WSRBegin[b] = min(vBegin, WSRBegin[b]);
+        }
+    }
+}
+
+/*
+ * description: release all working spaces of a task
+ * parameters: task ID
+ * return: none
+ * */
+static void prvResetWorking(int taskID){
+    WorkingVMIndex[taskID] = 0;
+    WorkingNVMIndex[taskID] = 0;
+}
+
+/*
+ * description: return the end of the validity interval of the current task, including the commits to the data it has read
+ * parameters: none
+ * return: the end, which the commit of the task folds into its vEnd
+ * note: should be called in critical sections, the end is not limited by timeCounter which still grows
+ * */
+unsigned long getTaskEnd(){
+    int slot = pxCurrentTCB->taskID;
+
+    if(WSRValid[slot] > 0 && WSRTCB[slot] == pxCurrentTCB->uxTCBNumber)
+        return min(pxCurrentTCB->vEnd, WSRBegin[slot]-1);
+    return pxCurrentTCB->vEnd;
+}
+
+/*
+ * description: check if the validity interval of the current task has collapsed, so that its commit must fail
+ * parameters: none
+ * return: 1 if the task cannot commit, 0 otherwise
+ * note: should be called in critical sections
+ * */
+static int prvCollapsed(){
+    return pxCurrentTCB->vBegin > getTaskEnd();
+}
+
+/*
+ * description: rerun the current task which cannot commit anymore
+ * parameters: none
+ * return: none, the task is deleted
+ * */
+static void prvAbort(){
+#ifdef DBPROFILE
+    DBabortCount++;
+    DBearlyAbortCount++;
+#endif
+    regTaskEnd();
+    taskRerun();
+}
+
+/*
+ * description: rerun the current task if DBtickValidate has found it unable to commit
+ * parameters: none
+ * return: none
+ * */
+static void prvCheckDoomed(){
+#ifdef DBEARLYABORT
+    //a doomed transaction fails at DBtxCommit
+    if(Doomed[pxCurrentTCB->taskID] && InTx[pxCurrentTCB->taskID] == 0)
+        prvAbort();
+#endif
+}
+
+/*
+ * description: reserve an id for a data object which is created by its first DBcommit
+ * parameters: none
+ * return: the reserved id, -1 for failure
+ * */
+int DBreserve(){
+    int id;
+
+    DBENTER_CRITICAL();
+    id = dataId;
+    if(id < NUMOBJ)
+        dataId++;
+    DBEXIT_CRITICAL();
+
+    return (id < NUMOBJ)? id : -1;
+}
+
+/*
+ * description: check if a version is pinned by a read lease
+ * parameters: address of the version
+ * return: the slot of a holder, -1 if the version is not leased
+ * note: should be called in critical sections
+ * */
+static int prvLeased(const void* address){
+    int i;
+
+    for(i = 0; i < LEASEENTRIES; i++)
+        if(Leases[i].address == address)
+            return Leases[i].slot;
+    return -1;
+}
+
+#ifndef SHADOWSLOT
+/*
+ * description: free the versions replaced by a commit, a leased version is freed by its last lease instead
+ * parameters: the replaced versions(NULL for none), number of the versions
+ * return: none
+ * */
+static void prvFreePrevious(void** previous, int num){
+    int j, k;
+
+    DBENTER_CRITICAL();
+    for(k = 0; k < num; k++){
+        if(previous[k] != NULL && prvLeased(previous[k]) >= 0){
+            for(j = 0; j < LEASEENTRIES; j++)
+                if(Leases[j].address == previous[k])
+                    Leases[j].deferred = 1;
+            previous[k] = NULL;
+        }
+    }
+    DBEXIT_CRITICAL();
+
+    for(k = 0; k < num; k++)
+        DBfree(&previous[k]);
+}
+#endif
+
+/*
+ * description: lock the objects to be committed and assign ids for the created objects
+ * parameters: working spaces, number of the data
+ * return: none
+ * note: the objects are locked all together in a short critical section, the task is delayed if any of them is being committed by others.
+ *       With SHADOWSLOT the task also waits here for the leases of other tasks on the slots to be written, so it never waits with the locks
+ * */
+static void prvLockObjects(struct working *work, int num){
+    int k, busy;
+#ifdef SHADOWSLOT
+    int holder;
+#endif
+
+    while(1){
+        DBENTER_CRITICAL();
+        busy = 0;
+        for(k = 0; k < num; k++){
+            if(work[k].id >= 0 && CHECK_BIT(commitLock[work[k].id/16], work[k].id%16))
+                busy = 1;
+#ifdef SHADOWSLOT
+            else if(work[k].id >= 0 && work[k].id < NUMOBJ && DB[work[k].id].size > 0){
+                holder = prvLeased(accessShadow(work[k].id));
+                if(holder >= 0 && holder != pxCurrentTCB->taskID)
+                    busy = 1;
+            }
+#endif
+        }
+        if(busy == 0)
+            break;
+        DBEXIT_CRITICAL();
+        vTaskDelay(1);//let the owner, even with a lower priority, finish its commit
+    }
+
+    for(k = 0; k < num; k++){
+        if(work[k].id < 0)//creation
+            work[k].id = dataId++;
+        if(work[k].id < NUMOBJ)
+            commitLock[work[k].id/16] |= 1 << (work[k].id%16);
+    }
+    DBEXIT_CRITICAL();
+}
+
+/*
+ * description: unlock the committed objects
+ * parameters: ids of the objects, number of the data
+ * return: none
+ * note: should be called in critical sections
+ * */
+static void prvUnlockObjects(int* workId, int num){
+    int k;
+
+    for(k = 0; k < num; k++)
+        if(workId[k] < NUMOBJ)
+            commitLock[workId[k]/16] &= ~(1 << (workId[k]%16));
+}
+
+/*
+ * description: free the new versions of a commit which is not linked
+ * parameters: ids of the objects, creation flags, new versions, number of the data
+ * return: none
+ * note: with SHADOWSLOT only the preallocated versions of the created objects are freed, as the objects stay uncreated
+ * */
+static void prvDropVersions(int* workId, int* creation, void** temp, int num){
+    int k;
+#ifdef SHADOWSLOT
+    void* base;
+
+    for(k = 0; k < num; k++){
+        if(creation[k] == 0)
+            continue;
+        base = accessBase(workId[k]);
+        initShadow(workId[k], NULL, 0);//unlinked before it is freed
+        DB[workId[k]].capacity = 0;
+        if(base != NULL)
+            vPortFree(base);
+    }
+    ( void ) temp;
+#else
+    ( void ) workId;
+    ( void ) creation;
+    for(k = 0; k < num; k++)
+        DBfree(&temp[k]);
+#endif
+}
+
+#ifdef GROUPCOMMIT
+/*
+ * description: wait for the staged commit of the task to be published, then free the versions it replaced
+ * parameters: task slot
+ * return: none
+ * note: the task reads its own writes only after they are published
+ * */
+static void prvRetireStaged(int slot){
+    while(Staged[slot].state == STAGED)
+        vTaskDelay(1);
+    if(Staged[slot].state == PUBLISHED){
+#ifndef SHADOWSLOT
+        prvFreePrevious(Staged[slot].previous, Staged[slot].num);
+#endif
+        Staged[slot].state = STAGEFREE;
+    }
+}
+
+/*
+ * description: restrict a reader of a staged object, which still reads the published version
+ * parameters: id of the data, task slot of the reader
+ * return: none
+ * note: should be called in critical sections
+ * */
+static void prvReadStaged(int id, int slot){
+    if(CHECK_BIT(stagedObj[id/16], id%16) && WSRValid[slot] == 1 && WSRTCB[slot] == pxCurrentTCB->uxTCBNumber)
+        WSRBegin[slot] = min(WSRBegin[slot], stagedBegin[id]);
+}
+
+/*
+ * description: publish all the staged commits by a single atomic switch, each one keeps its own valid interval
+ * parameters: none
+ * return: none
+ * note: called by the tick interrupt and at low voltage with GROUPCOMMIT, should be called in interrupts or critical sections
+ * */
+void DBpublish(){
+    int s, k, id, n = 0;
+
+    for(s = 0; s < NUMTASK; s++){
+        if(Staged[s].state != STAGED)
+            continue;
+        for(k = 0; k < Staged[s].num; k++){
+            batchId[n] = Staged[s].id[k];
+            batchAddress[n] = Staged[s].address[k];
+            batchBegin[n] = Staged[s].vBegin;
+            batchEnd[n] = Staged[s].vEnd;
+            n++;
+        }
+    }
+    if(n == 0)
+        return;
+
+    commitBatch(n, batchId, batchAddress, batchBegin, batchEnd);
+
+    for(s = 0; s < NUMTASK; s++){
+        if(Staged[s].state != STAGED)
+            continue;
+        for(k = 0; k < Staged[s].num; k++){
+            id = Staged[s].id[k];
+            DB[id].size = Staged[s].size[k];
+            DB[id].cacheAdd = NULL;
+            stagedObj[id/16] &= ~(1 << (id%16));
+#ifdef DBCRC
+            prvRecent(id);
+#endif
+        }
+        prvUnlockObjects(Staged[s].id, Staged[s].num);
+        markCommit(s);
+        Staged[s].state = PUBLISHED;
+    }
+#ifdef DBPROFILE
+    DBbatchCount++;
+#endif
+}
+
+#ifdef DBCOALESCE
+/*
+ * description: rewrite the unpublished versions of the task's staged commit when the task commits the same objects again
+ * parameters: working spaces, size in terms of bytes, number of the data
+ * return: 1 if the commit is coalesced into the staged one, 0 if it has to be committed by itself, -1 for failed validation
+ * note: nobody reads an unpublished version, so it is rewritten in place. A power failure during the rewrite makes
+ *       DBrecovery drop the staged commit, which is never published, and the task reruns anyway.
+ * */
+static int prvCoalesce(struct working *work, int size, int num){
+    int k, slot = pxCurrentTCB->taskID;
+    struct stagedCommit* staged = &Staged[slot];
+
+    if(staged->state != STAGED || staged->num != num)
+        return 0;
+    for(k = 0; k < num; k++)
+        if(work[k].id != staged->id[k] || (unsigned int)((work[k].size > 0)? work[k].size : size) != staged->size[k])
+            return 0;
+
+    DBENTER_CRITICAL();
+    if(staged->state != STAGED){//published meanwhile
+        DBEXIT_CRITICAL();
+        return 0;
+    }
+
+    /* Validation: the write set is still locked by the staged commit, so only the reads since then restrict the task */
+    if(WSRValid[slot] > 0 && WSRTCB[slot] == pxCurrentTCB->uxTCBNumber){
+        pxCurrentTCB->vEnd = min(pxCurrentTCB->vEnd, WSRBegin[slot]-1);
+        WSRBegin[slot] = 4294967295;
+    }
+    pxCurrentTCB->vEnd = min(pxCurrentTCB->vEnd, timeCounter);
+    if(pxCurrentTCB->vBegin > pxCurrentTCB->vEnd){
+        //the rerun commits again, the staged commit is dropped
+        for(k = 0; k < num; k++)
+            stagedObj[staged->id[k]/16] &= ~(1 << (staged->id[k]%16));
+        prvUnlockObjects(staged->id, num);
+        staged->state = STAGEREWRITE;
+        DBEXIT_CRITICAL();
+#ifndef SHADOWSLOT
+        for(k = 0; k < num; k++)
+            DBfree(&staged->address[k]);
+#endif
+        staged->state = STAGEFREE;
+#ifdef DBPROFILE
+        DBabortCount++;
+#endif
+        if(InTx[slot])//retried from DBtxBegin
+            return -1;
+        regTaskEnd();
+        taskRerun();
+        return -1;
+    }
+    staged->state = STAGEREWRITE;
+    DBEXIT_CRITICAL();
+
+    for(k = 0; k < num; k++){
+        DMAcopy(staged->address[k], work[k].address, staged->size[k]);
+#ifdef DBCRC
+        prvSeal(staged->address[k], staged->size[k]);
+#endif
+#ifdef DBPROFILE
+        DBwriteBytes += staged->size[k];
+#endif
+    }
+
+    DBENTER_CRITICAL();
+    staged->vBegin = pxCurrentTCB->vBegin;
+    staged->vEnd = pxCurrentTCB->vEnd;
+    staged->state = STAGED;
+    DBEXIT_CRITICAL();
+
+#ifdef DBPROFILE
+    DBcommitCount++;
+    DBcoalesceCount++;
+#endif
+    prvResetWorking(slot);
+    return 1;
+}
+#endif
+#endif
+
+#ifdef DBELIDE
+/*
+ * description: check if a working space equals the committed version of the data
+ * parameters: id of the data, working space, size of the data
+ * return: 1 if they are equal, 0 otherwise
+ * note: with DBCRC the CRC32 sealed in the version rejects most changed data before comparing the bytes
+ * */
+static int prvUnchanged(int id, const void* address, unsigned int size){
+    const void* version = accessData(id);
+
+#ifdef DBCRC
+    if(checksum((void*)address, size) != *(uint32_t*)((uint8_t*)version + CRCOFFSET(size)))
+        return 0;
+#endif
+    return memcmp(address, version, size) == 0;
+}
+#endif
+
+#ifdef UNDOLOG
+/*
+ * description: enter a critical section to read the data once it is not being overwritten in place
+ * parameters: id of the data
+ * return: none, the caller exits the critical section
+ * */
+static void prvEnterRead(int id){
+    while(1){
+        DBENTER_CRITICAL();
+        if(CHECK_BIT(inPlaceObj[id/16], id%16) == 0)
+            return;
+        DBEXIT_CRITICAL();
+        vTaskDelay(1);
+    }
+}
+#endif
+
+#if defined(UNDOLOG) || defined(DBCACHE)
+/*
+ * description: restrict the tasks that have read the data as prvInvalidateReaders does, and doom the ones still holding
+ *              a pointer to the version which is overwritten
+ * parameters: id of the data, begin of the writer's valid interval, task slot of the writer
+ * return: none
+ * note: should be called in critical sections, the readers which copied the data read a consistent version
+ * */
+static void prvDoomReaders(int id, unsigned long vBegin, int self){
+    int b;
+
+    for(b = 0; b < NUMTASK; b++){
+        if(b != self && CHECK_BIT(DB[id].readers[b/16], b%16) && WSRValid[b] == 1 && DB[id].readGen[b] == WSRGen[b]){
+            if(HoldsPointer[b]){
+                WSRBegin[b] = 1;//every read makes vBegin at least 1, so the interval collapses
+                Doomed[b] = 1;
+            }
+            else
+                WSRBegin[b] = min(vBegin, WSRBegin[b]);
+        }
+    }
+}
+#endif
+
+#ifdef UNDOLOG
+/*
+ * description: commit by overwriting the versions in place, the previous versions are kept in the undo log of the task
+ * parameters: ids, sizes and working spaces of the locked data, whether each one is created, number of the data,
+ *             ids and number of the elided data which are locked as well
+ * return: 1 if committed, 0 if the versions have to be switched instead, -1 for failed validation
+ * note: only the commits of existing data whose size is unchanged and whose versions fit UNDOSIZE are done in place,
+ *       a leased version is never overwritten. The readers still holding a pointer from DBread are doomed, the others
+ *       are restricted, and the later ones wait until the versions are rewritten. The validity intervals follow the ones of a switch.
+ * */
+static int prvCommitInPlace(int* workId, int* workSize, void** workAddress, int* creation, int num, int* elidedId, int elided){
+    int k, slot = pxCurrentTCB->taskID;
+    struct undoLog* log = &Undo[slot];
+    unsigned int bytes = 0;
+
+    if(num == 0)
+        return 0;
+    for(k = 0; k < num; k++){
+        if(creation[k] || (unsigned int)workSize[k] != DB[workId[k]].size)
+            return 0;
+        bytes += (VERSIONSIZE(workSize[k]) + 1) & ~1;
+    }
+    if(bytes > UNDOSIZE)
+        return 0;
+
+    DBENTER_CRITICAL();
+    for(k = 0; k < num; k++){
+        if(prvLeased(accessData(workId[k])) >= 0){
+            DBEXIT_CRITICAL();
+            return 0;
+        }
+    }
+    for(k = 0; k < num; k++)
+        inPlaceObj[workId[k]/16] |= 1 << (workId[k]%16);
+
+    /* Validation, as DBcommit */
+    if(WSRValid[slot] > 0 && WSRTCB[slot] == pxCurrentTCB->uxTCBNumber){
+        pxCurrentTCB->vEnd = min(pxCurrentTCB->vEnd, WSRBegin[slot]-1);
+        WSRBegin[slot] = 4294967295;
+    }
+    for(k = 0; k < num; k++)
+        pxCurrentTCB->vBegin = max(pxCurrentTCB->vBegin, getBegin(workId[k])+1);
+    for(k = 0; k < elided; k++)
+        pxCurrentTCB->vBegin = max(pxCurrentTCB->vBegin, getBegin(elidedId[k])+1);
+    pxCurrentTCB->vEnd = min(pxCurrentTCB->vEnd, timeCounter);
+
+    if(pxCurrentTCB->vBegin > pxCurrentTCB->vEnd){
+        for(k = 0; k < num; k++)
+            inPlaceObj[workId[k]/16] &= ~(1 << (workId[k]%16));
+        prvUnlockObjects(workId, num);
+        prvUnlockObjects(elidedId, elided);
+        DBEXIT_CRITICAL();
+#ifdef DBPROFILE
+        DBabortCount++;
+#endif
+        if(InTx[slot])//retried from DBtxBegin
+            return -1;
+        regTaskEnd();
+        taskRerun();
+        return -1;
+    }
+    for(k = 0; k < num; k++)
+        prvDoomReaders(workId[k], pxCurrentTCB->vBegin, slot);
+    prvUnlockObjects(elidedId, elided);
+    DBEXIT_CRITICAL();
+
+    /* log the previous versions, the log is published by the number of its records */
+    log->num = 0;
+    for(k = 0, bytes = 0; k < num; k++){
+        log->id[k] = workId[k];
+        log->size[k] = workSize[k];
+        log->offset[k] = bytes;
+        log->vBegin[k] = getBegin(workId[k]);
+        log->vEnd[k] = getEnd(workId[k]);
+        log->time[k] = getCommitTime(workId[k], 0);
+        DMAcopy(&log->space[bytes], accessData(workId[k]), VERSIONSIZE(workSize[k]));
+        bytes += (VERSIONSIZE(workSize[k]) + 1) & ~1;
+#ifdef DBPROFILE
+        DBwriteBytes += workSize[k];//the undo record is written to FRAM as well
+#endif
+    }
+    log->num = num;
+
+    /* overwrite the versions */
+    for(k = 0; k < num; k++){
+        DMAcopy(accessData(workId[k]), workAddress[k], workSize[k]);
+#ifdef DBCRC
+        prvSeal(accessData(workId[k]), workSize[k]);
+#endif
+#ifdef DBPROFILE
+        DBwriteBytes += workSize[k];
+#endif
+    }
+
+    /* publish the new intervals, the commit is done once the log is cleared */
+    DBENTER_CRITICAL();
+    for(k = 0; k < num; k++){
+        setValidity(workId[k], pxCurrentTCB->vBegin, pxCurrentTCB->vEnd);
+        setCommitTime(workId[k], timeCounter);
+        DB[workId[k]].cacheAdd = NULL;
+        prvInvalidateReaders(workId[k], pxCurrentTCB->vBegin, slot);
+#ifdef DBCRC
+        prvRecent(workId[k]);
+#endif
+    }
+    log->num = 0;
+    for(k = 0; k < num; k++)
+        inPlaceObj[workId[k]/16] &= ~(1 << (workId[k]%16));
+    prvUnlockObjects(workId, num);
+    DBEXIT_CRITICAL();
+
+#ifdef DBPROFILE
+    DBcommitCount++;
+#endif
+    markCommit(slot);
+    prvResetWorking(slot);
+    return 1;
+}
+#endif
+
+#ifdef DBCACHE
+/*
+ * description: find the cache entry of the data
+ * parameters: id of the data
+ * return: index of the entry, -1 if the data is not cached
+ * note: should be called in critical sections
+ * */
+static int prvCacheEntry(int id){
+    int e;
+
+    if(DB[id].cacheAdd == NULL)
+        return -1;
+    for(e = 0; e < CACHEENTRIES; e++)
+        if(Cache[e].id == id && DB[id].cacheAdd == &CacheSpace[Cache[e].offset])
+            return e;
+    return -1;
+}
+
+/*
+ * description: copy the dirty cached objects to their staged versions outside critical sections, for prvCacheWriteBack
+ * parameters: the staging filled by the copies
+ * return: none, s->num is 0 if nothing is staged
+ * note: one task stages at a time, so the entries and their versions stay allocated during the copies.
+ *       A copy changed by a commit during the staging is not published, prvCacheWriteBack copies it again.
+ * */
+static void prvCacheStage(struct cacheStaging* s){
+    int e, k;
+
+    s->num = 0;
+    DBENTER_CRITICAL();
+    if(cacheBusy == 0){
+        for(e = 0; e < CACHEENTRIES; e++){
+            if(Cache[e].id < 0 || Cache[e].dirty == 0 || prvCacheEntry(Cache[e].id) != e)
+                continue;
+            s->entry[s->num] = e;
+            s->id[s->num] = Cache[e].id;
+            s->gen[s->num] = Cache[e].gen;
+            s->num++;
+        }
+        cacheBusy = (s->num > 0);
+    }
+    DBEXIT_CRITICAL();
+
+    for(k = 0; k < s->num; k++){
+        e = s->entry[k];
+        DMAcopy(cacheStage[s->id[k]], &CacheSpace[Cache[e].offset], Cache[e].size);
+#ifdef DBCRC
+        prvSeal(cacheStage[s->id[k]], Cache[e].size);
+#endif
+    }
+}
+
+/*
+ * description: write the dirty cached objects back to FRAM by a single atomic switch
+ * parameters: the staging of prvCacheStage, NULL to copy all the objects here
+ * return: none
+ * note: should be called in interrupts or critical sections. The staged versions which are still current are linked,
+ *       the other copies are written to the preallocated shadows. The replaced versions take the place of the linked
+ *       ones, so nothing is allocated or freed.
+ * */
+static void prvCacheWriteBack(struct cacheStaging* s){
+    int e, k, id, n = 0;
+    int ids[CACHEENTRIES];
+    unsigned char staged[CACHEENTRIES];
+    void* address[CACHEENTRIES];
+    unsigned long begin[CACHEENTRIES], end[CACHEENTRIES];
+
+    for(e = 0; e < CACHEENTRIES; e++){
+        id = Cache[e].id;
+        if(id < 0 || Cache[e].dirty == 0 || prvCacheEntry(id) != e)
+            continue;
+        for(k = 0; s != NULL && k < s->num; k++)
+            if(s->entry[k] == e && s->id[k] == id && s->gen[k] == Cache[e].gen)
+                break;
+        staged[n] = (s != NULL && k < s->num);
+        if(staged[n])
+            address[n] = cacheStage[id];
+        else{
+            DMAcopy(cacheShadow[id], &CacheSpace[Cache[e].offset], Cache[e].size);
+#ifdef DBCRC
+            prvSeal(cacheShadow[id], Cache[e].size);
+#endif
+            address[n] = cacheShadow[id];
+        }
+        ids[n] = id;
+        begin[n] = getBegin(id);
+        end[n] = getEnd(id);
+        n++;
+#ifdef DBPROFILE
+        DBwriteBytes += Cache[e].size;
+#endif
+    }
+    if(n > 0){
+        commitBatch(n, ids, address, begin, end);
+        for(k = 0; k < n; k++){
+            if(staged[k])
+                cacheStage[ids[k]] = accessShadow(ids[k]);
+            else
+                cacheShadow[ids[k]] = accessShadow(ids[k]);
+#ifdef DBCRC
+            prvRecent(ids[k]);
+#endif
+        }
+    }
+    for(e = 0; e < CACHEENTRIES; e++)
+        Cache[e].dirty = 0;
+    if(s != NULL && s->num > 0)
+        cacheBusy = 0;
+#ifdef DBPROFILE
+    if(n > 0)
+        DBflushCount++;
+#endif
+}
+
+/*
+ * description: write the cached commits back to FRAM before the power fails, commits are not cached until DBcacheResume
+ * parameters: none
+ * return: none
+ * note: called by ADC12_ISR at low voltage
+ * */
+void DBcacheFlush(){
+    cacheWriteThrough = 1;
+    prvCacheWriteBack(NULL);
+}
+
+/*
+ * description: cache the commits again after DBcacheFlush
+ * parameters: none
+ * return: none
+ * note: called by ADC12_ISR when the voltage is high again
+ * */
+void DBcacheResume(){
+    cacheWriteThrough = 0;
+}
+
+/*
+ * description: stop caching the data, a dirty copy is written back first
+ * parameters: id of the data
+ * return: none
+ * note: should be called in critical sections, the entry and its shadow are freed by prvCacheReap
+ * */
+static void prvCacheDrop(int id){
+    int e = prvCacheEntry(id);
+
+    if(e < 0)
+        return;
+    if(Cache[e].dirty)
+        prvCacheWriteBack(NULL);
+    DB[id].cacheAdd = NULL;
+}
+
+/*
+ * description: free the entries dropped by commits which bypass the cache, and their shadows
+ * parameters: none
+ * return: none
+ * */
+static void prvCacheReap(){
+    int e, id;
+
+    for(e = 0; e < CACHEENTRIES; e++){
+        DBENTER_CRITICAL();
+        id = Cache[e].id;
+        if(id >= 0 && prvCacheEntry(id) == e)
+            id = -1;
+        else
+            Cache[e].id = -1;
+        DBEXIT_CRITICAL();
+        if(id >= 0){
+            DBfree(&cacheShadow[id]);
+            DBfree(&cacheStage[id]);
+        }
+    }
+}
+
+/*
+ * description: find a free range of the cache for a copy
+ * parameters: size of the copy, the offset found
+ * return: 1 if found, 0 otherwise
+ * note: should be called in critical sections
+ * */
+static int prvCacheFit(unsigned int size, unsigned int* offset){
+    int e, f, overlap;
+    unsigned int at;
+
+    for(f = -1; f < CACHEENTRIES; f++){
+        //a copy is placed at the beginning or right after another copy
+        if(f >= 0 && Cache[f].id < 0)
+            continue;
+        at = (f < 0)? 0 : (Cache[f].offset + Cache[f].size + 1) & ~1;
+        if(at + size > CACHESIZE)
+            continue;
+        for(e = 0, overlap = 0; e < CACHEENTRIES; e++)
+            if(Cache[e].id >= 0 && at < Cache[e].offset + Cache[e].size && Cache[e].offset < at + size)
+                overlap = 1;
+        if(overlap == 0){
+            *offset = at;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * description: check if no task may still be reading the cached copy of the data
+ * parameters: id of the data
+ * return: 1 if the copy can be evicted, 0 otherwise
+ * note: should be called in critical sections
+ * */
+static int prvCacheIdle(int id){
+    int b;
+
+    for(b = 0; b < NUMTASK; b++)
+        if(CHECK_BIT(DB[id].readers[b/16], b%16) && WSRValid[b] == 1 && DB[id].readGen[b] == WSRGen[b])
+            return 0;
+    return 1;
+}
+
+/*
+ * description: count a read of the data, and cache it if it is read often enough, the least read clean copies are evicted for it
+ * parameters: id of the data
+ * return: none
+ * note: a leased or locked data is not cached, and only the clean copies without readers are evicted for more frequently read data
+ * */
+static void prvCacheAdmit(int id){
+    int e, free, victim;
+    unsigned int offset, size = DB[id].size;
+
+    DBENTER_CRITICAL();
+    if(++cacheReads >= CACHEAGING){
+        cacheReads = 0;
+        for(e = 0; e < NUMOBJ; e++)
+            cacheHits[e] >>= 1;
+    }
+    if(cacheHits[id] < 255)
+        cacheHits[id]++;
+    if(DB[id].cacheAdd != NULL || cacheHits[id] < CACHEADMIT || size > CACHESIZE || cacheBusy){
+        DBEXIT_CRITICAL();
+        return;
+    }
+    cacheBusy = 1;
+    DBEXIT_CRITICAL();
+
+    prvCacheReap();
+    while(1){
+        DBENTER_CRITICAL();
+        for(e = 0, free = -1, victim = -1; e < CACHEENTRIES; e++){
+            if(Cache[e].id < 0)
+                free = e;
+            else if(Cache[e].dirty == 0 && cacheHits[Cache[e].id] < cacheHits[id] && prvCacheIdle(Cache[e].id) && (victim < 0 || cacheHits[Cache[e].id] < cacheHits[Cache[victim].id]))
+                victim = e;
+        }
+        if(free >= 0 && prvCacheFit(size, &offset))
+            break;
+        if(victim >= 0)
+            DB[Cache[victim].id].cacheAdd = NULL;
+        DBEXIT_CRITICAL();
+        if(victim < 0){//colder than all the copies
+            cacheBusy = 0;
+            return;
+        }
+        prvCacheReap();
+    }
+    DBEXIT_CRITICAL();
+
+    DBalloc(VERSIONSIZE(size), &cacheShadow[id]);
+    DBalloc(VERSIONSIZE(size), &cacheStage[id]);
+    DBENTER_CRITICAL();
+    if(cacheShadow[id] != NULL && cacheStage[id] != NULL && CHECK_BIT(commitLock[id/16], id%16) == 0 && prvLeased(accessData(id)) < 0 && DB[id].size == size){
+        DMAcopy(&CacheSpace[offset], accessData(id), size);
+        Cache[free].id = id;
+        Cache[free].offset = offset;
+        Cache[free].size = size;
+        Cache[free].dirty = 0;
+        Cache[free].gen = 0;
+        DB[id].cacheAdd = &CacheSpace[offset];
+    }
+    DBEXIT_CRITICAL();
+    if(DB[id].cacheAdd == NULL){
+        DBfree(&cacheShadow[id]);
+        DBfree(&cacheStage[id]);
+    }
+    cacheBusy = 0;
+}
+
+/*
+ * description: commit by updating the cached copies, which are written back to FRAM later by DBcacheFlush
+ * parameters: ids, sizes and working spaces of the locked data, number of the data, ids and number of the elided data
+ * return: 1 if committed, 0 if the commit bypasses the cache, -1 for failed validation
+ * note: only the commits whose data are all cached with the same size are cached, other commits write the dirty copies
+ *       back first, so the commits published in FRAM never depend on the ones which can be lost. The readers of
+ *       the copies are doomed as the copies are overwritten, and the validity intervals follow the ones of a switch.
+ * */
+static int prvCommitCached(int* workId, int* workSize, void** workAddress, int num, int* elidedId, int elided){
+    int e, k, slot = pxCurrentTCB->taskID;
+    struct cacheStaging staging;
+
+    DBENTER_CRITICAL();
+    for(k = 0; k < num; k++)
+        if(prvCacheEntry(workId[k]) < 0 || Cache[prvCacheEntry(workId[k])].size != (unsigned int)workSize[k])
+            break;
+    if(num == 0 || k < num || cacheWriteThrough){
+        DBEXIT_CRITICAL();
+        prvCacheStage(&staging);
+        DBENTER_CRITICAL();
+        prvCacheWriteBack(&staging);
+        DBEXIT_CRITICAL();
+        return 0;
+    }
+
+    /* Validation, as DBcommit */
+    if(WSRValid[slot] > 0 && WSRTCB[slot] == pxCurrentTCB->uxTCBNumber){
+        pxCurrentTCB->vEnd = min(pxCurrentTCB->vEnd, WSRBegin[slot]-1);
+        WSRBegin[slot] = 4294967295;
+    }
+    for(k = 0; k < num; k++)
+        pxCurrentTCB->vBegin = max(pxCurrentTCB->vBegin, getBegin(workId[k])+1);
+    for(k = 0; k < elided; k++)
+        pxCurrentTCB->vBegin = max(pxCurrentTCB->vBegin, getBegin(elidedId[k])+1);
+    pxCurrentTCB->vEnd = min(pxCurrentTCB->vEnd, timeCounter);
+
+    if(pxCurrentTCB->vBegin > pxCurrentTCB->vEnd){
+        prvUnlockObjects(workId, num);
+        prvUnlockObjects(elidedId, elided);
+        DBEXIT_CRITICAL();
+#ifdef DBPROFILE
+        DBabortCount++;
+#endif
+        if(InTx[slot])//retried from DBtxBegin
+            return -1;
+        regTaskEnd();
+        taskRerun();
+        return -1;
+    }
+
+    /* update the copies, they are written back with the new validity intervals */
+    for(k = 0; k < num; k++){
+        e = prvCacheEntry(workId[k]);
+        prvDoomReaders(workId[k], pxCurrentTCB->vBegin, slot);
+        memcpy(&CacheSpace[Cache[e].offset], workAddress[k], workSize[k]);
+        Cache[e].dirty = 1;
+        Cache[e].gen++;
+        setValidity(workId[k], pxCurrentTCB->vBegin, pxCurrentTCB->vEnd);
+        setCommitTime(workId[k], timeCounter);
+        prvInvalidateReaders(workId[k], pxCurrentTCB->vBegin, slot);
+    }
+    prvUnlockObjects(workId, num);
+    prvUnlockObjects(elidedId, elided);
+    DBEXIT_CRITICAL();
+
+#ifdef DBPROFILE
+    DBcommitCount++;
+#endif
+    markCommit(slot);
+    prvResetWorking(slot);
+    return 1;
+}
+#endif
+
+/*
+ * description: create/write data entries, all the entries are published by a single atomic switch
+ * parameters: working spaces of the data(max for MAXCOMMIT data commit atomically), size in terms of bytes, number of the data
+ * return: the id of the first data, -1 for failure
+ * note: work[i].size overrides the size for the i-th entry if it is set, ids of the created data are returned in work[i].id
+ *       The objects are locked while their new versions are copied with interrupts enabled, interrupts are only disabled
+ *       to validate, switch the maps and restrict the readers.
+ * */
+int DBcommit(struct working *work, int size, int num){
+    int j, k, first;
+    int creation[MAXCOMMIT], workId[MAXCOMMIT], workSize[MAXCOMMIT];
+    void* workAddress[MAXCOMMIT];
+#ifdef DBELIDE
+    int elided = 0, elidedId[MAXCOMMIT];
+#endif
+#ifdef DBSLAB
+    //the versions are recorded in FRAM by the intent of the task slot
+    struct versionIntent* intent = &Intents[pxCurrentTCB->taskID];
+    void** previous = intent->previous;
+    void** temp = intent->address;
+#else
+#ifndef SHADOWSLOT
+    void* previous[MAXCOMMIT];//the preallocated versions of SHADOWSLOT are never replaced
+#endif
+    void* temp[MAXCOMMIT];
+#endif
+
+    if(num <= 0 || num > MAXCOMMIT || ReadOnly[pxCurrentTCB->taskID])
+        return -1;
+    prvCheckDoomed();
+#ifdef GROUPCOMMIT
+#ifdef DBCOALESCE
+    j = prvCoalesce(work, size, num);
+    if(j != 0)
+        return (j > 0)? work[0].id : -1;
+#endif
+    prvRetireStaged(pxCurrentTCB->taskID);
+#endif
+
+    /* invalid ID or an object committed twice */
+    for(k = 0; k < num; k++){
+        if(work[k].id >= NUMOBJ)
+            return -1;
+        for(j = 0; j < k; j++)
+            if(work[k].id >= 0 && work[j].id == work[k].id)
+                return -1;
+#ifdef SHADOWSLOT
+        //the preallocated versions cannot grow
+        if(work[k].id >= 0 && DB[work[k].id].size > 0 && (unsigned int)((work[k].size > 0)? work[k].size : size) > DB[work[k].id].capacity)
+            return -1;
+#endif
+    }
+
+    /* lock the objects, and create the new ones and the reserved ones without any committed version */
+    prvLockObjects(work, num);
+    for(k = 0; k < num; k++){
+        workId[k] = work[k].id;
+        workSize[k] = (work[k].size > 0)? work[k].size : size;
+        workAddress[k] = work[k].address;
+    }
+    for(k = 0; k < num; k++){
+        if(workId[k] >= NUMOBJ)//run out of objects
+            break;
+        //decided under the lock, as tasks committing the same reserved id are serialized by it
+        creation[k] = (DB[workId[k]].size == 0);
+#ifdef SHADOWSLOT
+        if(creation[k] == 0 && (unsigned int)workSize[k] > DB[workId[k]].capacity)
+            break;
+#endif
+    }
+    if(k < num){
+        DBENTER_CRITICAL();
+        prvUnlockObjects(workId, num);
+        DBEXIT_CRITICAL();
+        return -1;
+    }
+    first = workId[0];
+#ifdef DBELIDE
+    /* drop the entries equal to their committed versions, they stay locked so that the versions are current at validation */
+    for(k = 0, j = 0; k < num; k++){
+        if(creation[k] == 0 && (unsigned int)workSize[k] == DB[workId[k]].size && prvUnchanged(workId[k], workAddress[k], workSize[k]))
+            elidedId[elided++] = workId[k];
+        else{
+            creation[j] = creation[k];
+            workId[j] = workId[k];
+            workSize[j] = workSize[k];
+            workAddress[j] = workAddress[k];
+            j++;
+        }
+    }
+    num = j;
+#ifdef DBPROFILE
+    DBelideCount += elided;
+#endif
+#endif
+#ifdef UNDOLOG
+#ifdef DBELIDE
+    j = prvCommitInPlace(workId, workSize, workAddress, creation, num, elidedId, elided);
+#else
+    j = prvCommitInPlace(workId, workSize, workAddress, creation, num, NULL, 0);
+#endif
+    if(j != 0)
+        return (j > 0)? first : -1;
+#endif
+#ifdef DBCACHE
+#ifdef DBELIDE
+    j = prvCommitCached(workId, workSize, workAddress, num, elidedId, elided);
+#else
+    j = prvCommitCached(workId, workSize, workAddress, num, NULL, 0);
+#endif
+    if(j != 0)
+        return (j > 0)? first : -1;
+#endif
+#ifdef DBSLAB
+    intent->num = 0;
+    for(k = 0; k < num; k++){
+        intent->id[k] = workId[k];
+        temp[k] = NULL;
+        previous[k] = NULL;
+    }
+    intent->num = num;
+#endif
+
+    /* copy the new versions, the locks keep other writers away from the versions */
+    //working at VM, then write to a new space in NVM as consistent version
+    for(k = 0; k < num; k++){
+#ifdef SHADOWSLOT
+        //allocate all versions at creation, then rotate between them
+        if(creation[k] == 1){
+            temp[k] = (void*)pvPortMalloc(NUMVERSION * VERSIONSIZE(workSize[k]));
+            if(temp[k] == NULL)
+                break;
+            initShadow(workId[k], temp[k], VERSIONSIZE(workSize[k]));
+            DB[workId[k]].capacity = workSize[k];
+        }
+        //the leases of other tasks on the inactive slot are waited for by prvLockObjects, and no new lease pins it under the lock
+        DBENTER_CRITICAL();
+        j = prvLeased(accessShadow(workId[k]));
+        DBEXIT_CRITICAL();
+        if(j >= 0)//the task pins the slot by itself, waiting will never end
+            break;
+        temp[k] = accessShadow(workId[k]);
+#else
+        //the version replaced by the commit needs to be freed after commit
+        previous[k] = NULL;
+        if(creation[k] == 0)
+#if NUMVERSION > 2
+            previous[k] = accessShadow(workId[k]);//the oldest version leaves the ring
+#else
+            previous[k] = accessData(workId[k]);
+#endif
+        DBalloc(VERSIONSIZE(workSize[k]), &temp[k]);
+        if(temp[k] == NULL)
+            break;
+#endif
+        DMAcopy(temp[k], workAddress[k], workSize[k]);
+#ifdef DBCRC
+        prvSeal(temp[k], workSize[k]);
+#endif
+#ifdef DBPROFILE
+        DBwriteBytes += workSize[k];
+#endif
+    }
+    if(k < num){//run out of memory, or the task leases the slot to be written
+        prvDropVersions(workId, creation, temp, k);
+        DBENTER_CRITICAL();
+        prvUnlockObjects(workId, num);
+#ifdef DBELIDE
+        prvUnlockObjects(elidedId, elided);
+#endif
+        DBEXIT_CRITICAL();
+#ifndef SHADOWSLOT
+        for(k = 0; k < num; k++)
+            previous[k] = NULL;
+#endif
+#ifdef DBSLAB
+        intent->num = 0;
+#endif
+        return -1;
+    }
+
+    DBENTER_CRITICAL();
+
+    /* Validation */
+    // for read set that have been updated after the read
+    j = pxCurrentTCB->taskID;
+    if(WSRValid[j] > 0 && WSRTCB[j] == pxCurrentTCB->uxTCBNumber){
+        pxCurrentTCB->vEnd = min(pxCurrentTCB->vEnd,WSRBegin[j]-1);
+        WSRBegin[j] = 4294967295;//incase for a task with multiple commits
+    }
+
+    // for write set:
+    for(k = 0; k < num; k++)
+        if(creation[k] == 0)
+            pxCurrentTCB->vBegin = max(pxCurrentTCB->vBegin, getBegin(workId[k])+1);
+#ifdef DBELIDE
+    //an elided entry is still a write of the current version
+    for(k = 0; k < elided; k++)
+        pxCurrentTCB->vBegin = max(pxCurrentTCB->vBegin, getBegin(elidedId[k])+1);
+#endif
+
+    // should be finished no more later than current time
+    pxCurrentTCB->vEnd = min(pxCurrentTCB->vEnd, timeCounter);
+
+    // validation fail
+    if(pxCurrentTCB->vBegin > pxCurrentTCB->vEnd){
+        prvUnlockObjects(workId, num);
+#ifdef DBELIDE
+        prvUnlockObjects(elidedId, elided);
+#endif
+        DBEXIT_CRITICAL();
+        prvDropVersions(workId, creation, temp, num);
+#ifndef SHADOWSLOT
+        for(k = 0; k < num; k++)
+            previous[k] = NULL;
+#endif
+#ifdef DBPROFILE
+        DBabortCount++;
+#endif
+        if(InTx[pxCurrentTCB->taskID])//retried from DBtxBegin
+            return -1;
+        regTaskEnd();
+        taskRerun();
+        return -1;
+    }
+
+#ifdef DBELIDE
+    /* the readers of an elided entry still read its current value, so they are not restricted */
+    prvUnlockObjects(elidedId, elided);
+    if(num == 0){
+        DBEXIT_CRITICAL();
+#ifdef DBPROFILE
+        DBcommitCount++;
+#endif
+#ifdef DBSLAB
+        intent->num = 0;
+#endif
+        markCommit(pxCurrentTCB->taskID);
+        prvResetWorking(pxCurrentTCB->taskID);
+        return first;
+    }
+#endif
+
+#ifdef GROUPCOMMIT
+    /* validation success, stage the changes for DBpublish, the objects stay locked until then */
+    j = pxCurrentTCB->taskID;
+    for(k = 0; k < num; k++){
+        // the readers are restricted now, and the ones reading before the publish are restricted by prvReadStaged
+        prvInvalidateReaders(workId[k], pxCurrentTCB->vBegin, j);
+        stagedObj[workId[k]/16] |= 1 << (workId[k]%16);
+        stagedBegin[workId[k]] = pxCurrentTCB->vBegin;
+        Staged[j].id[k] = workId[k];
+        Staged[j].size[k] = workSize[k];
+        Staged[j].address[k] = temp[k];
+#ifndef SHADOWSLOT
+        Staged[j].previous[k] = previous[k];
+#endif
+    }
+    Staged[j].num = num;
+    Staged[j].vBegin = pxCurrentTCB->vBegin;
+    Staged[j].vEnd = pxCurrentTCB->vEnd;
+    Staged[j].state = STAGED;
+#ifdef DBSLAB
+    intent->num = 0;//the staged commit takes over the versions
+#endif
+
+    DBEXIT_CRITICAL();
+
+#ifdef DBPROFILE
+    DBcommitCount++;
+#endif
+    prvResetWorking(j);
+#else
+    /* validation success, commit all changes*/
+    commitGroup(num, workId, temp, pxCurrentTCB->vBegin, pxCurrentTCB->vEnd);
+#ifdef DBSLAB
+    for(k = 0; k < num; k++)
+        temp[k] = NULL;//linked by the maps
+#endif
+
+    for(k = 0; k < num; k++){
+        /* Link the data, the working space is reused after the commit */
+        DB[workId[k]].size = workSize[k];
+        DB[workId[k]].cacheAdd = NULL;
+
+        /* validation: for those written data read by other tasks*/
+        // all write set's readers can be removed after their valid interval is reduced
+        prvInvalidateReaders(workId[k], pxCurrentTCB->vBegin, pxCurrentTCB->taskID);
+#ifdef DBCRC
+        prvRecent(workId[k]);
+#endif
+    }
+    prvUnlockObjects(workId, num);
+
+    DBEXIT_CRITICAL();
+
+#ifdef DBPROFILE
+    DBcommitCount++;
+#endif
+    markCommit(pxCurrentTCB->taskID);
+    prvResetWorking(pxCurrentTCB->taskID);
+
+#ifndef SHADOWSLOT
+    /* Free the previous consistent data, the leased ones are freed by their leases */
+    prvFreePrevious(previous, num);
+#endif
+#ifdef DBSLAB
+    intent->num = 0;
+#endif
+#endif
+
+    return first;
+}
+
+#ifdef DBRESUME
+/*
+ * description: restrict a reader of an object with a large commit being copied, which still reads the replaced version
+ * parameters: id of the data, task slot of the reader
+ * return: none
+ * note: should be called in critical sections
+ * */
+static void prvReadResuming(int id, int slot){
+    int s;
+
+    for(s = 0; s < NUMTASK; s++)
+        if(Resumes[s].state == RESUMECOPY && Resumes[s].id == id && WSRValid[slot] == 1 && WSRTCB[slot] == pxCurrentTCB->uxTCBNumber)
+            WSRBegin[slot] = min(WSRBegin[slot], Resumes[s].vBegin);
+}
+
+/*
+ * description: write a large data object, which is validated first and then copied in chunks of RESUMECHUNK bytes
+ * parameters: working space of the data in FRAM, size in terms of bytes
+ * return: the id of the data, -1 for failure
+ * note: work->size overrides the size if it is set, and the id of a created data is returned in work->id.
+ *       The commit is decided at validation, a power failure during the copy is resumed by DBrecovery from the cursor
+ *       and the version is published by a single atomic switch at the end. The source must stay in FRAM until then,
+ *       so the working space has to be LOCNVM. The object is locked and its new readers are restricted during the copy.
+ *       The commits finished by the previous attempts of a run are returned to its rerun without copying, with the ids
+ *       of the first RESUMECALLS commits of the run. Later commits of the run cannot create data, reserve their ids by DBreserve.
+ * */
+int DBcommitLarge(struct working *work, int size){
+    int creation, slot = pxCurrentTCB->taskID;
+    unsigned int call;
+    struct resumableCommit* r = &Resumes[slot];
+#ifdef DBCACHE
+    struct cacheStaging staging;
+#endif
+
+    if(work->id >= NUMOBJ || work->loc != LOCNVM || ReadOnly[slot])
+        return -1;
+    if(work->id < 0 && r->calls >= RESUMECALLS)//the id would be lost by a rerun
+        return -1;
+    prvCheckDoomed();
+
+    /* number the commit in the run, the commits finished before a power failure are not copied again */
+    call = ++r->calls;
+    if(call <= r->done){
+        if(call <= RESUMECALLS)
+            work->id = r->ids[call-1];
+        prvResetWorking(slot);
+        return work->id;
+    }
+#ifdef GROUPCOMMIT
+    prvRetireStaged(slot);
+#endif
+    size = (work->size > 0)? work->size : size;
+
+    prvLockObjects(work, 1);
+    if(work->id >= NUMOBJ)//run out of objects
+        return -1;
+    creation = (DB[work->id].size == 0);
+    DBalloc(VERSIONSIZE(size), &r->version);
+    if(r->version == NULL){
+        DBENTER_CRITICAL();
+        prvUnlockObjects(&work->id, 1);
+        DBEXIT_CRITICAL();
+        return -1;
     }
-    dataId = 0;
 
-    for(i = 0; i < NUMTASK; i++)
-        WSRValid[i] = 0;
+#ifdef DBCACHE
+    prvCacheStage(&staging);
+#endif
+    DBENTER_CRITICAL();
+#ifdef DBCACHE
+    prvCacheWriteBack(&staging);//the cached commits are published before this one
+#endif
+
+    /* Validation, as DBcommit */
+    if(WSRValid[slot] > 0 && WSRTCB[slot] == pxCurrentTCB->uxTCBNumber){
+        pxCurrentTCB->vEnd = min(pxCurrentTCB->vEnd, WSRBegin[slot]-1);
+        WSRBegin[slot] = 4294967295;
+    }
+    if(creation == 0)
+        pxCurrentTCB->vBegin = max(pxCurrentTCB->vBegin, getBegin(work->id)+1);
+    pxCurrentTCB->vEnd = min(pxCurrentTCB->vEnd, timeCounter);
+    if(pxCurrentTCB->vBegin > pxCurrentTCB->vEnd){
+        prvUnlockObjects(&work->id, 1);
+        DBEXIT_CRITICAL();
+        DBfree(&r->version);
+#ifdef DBPROFILE
+        DBabortCount++;
+#endif
+        if(InTx[slot])
+            return -1;
+        regTaskEnd();
+        taskRerun();
+        return -1;
+    }
+
+    /* validation success, the commit is decided and recorded before the copy */
+    prvInvalidateReaders(work->id, pxCurrentTCB->vBegin, slot);
+    r->id = work->id;
+    r->call = call;
+    r->size = size;
+    r->cursor = 0;
+    r->from = work->address;
+#if NUMVERSION > 2
+    r->previous = (creation == 0)? accessShadow(work->id) : NULL;//the oldest version leaves the ring
+#else
+    r->previous = (creation == 0)? accessData(work->id) : NULL;
+#endif
+    r->vBegin = pxCurrentTCB->vBegin;
+    r->vEnd = pxCurrentTCB->vEnd;
+    r->state = RESUMECOPY;
+    DBEXIT_CRITICAL();
+
+    prvResumeCopy(r);
+#ifdef DBPROFILE
+    DBwriteBytes += size;
+    DBcommitCount++;
+#endif
+
+    DBENTER_CRITICAL();
+    prvInvalidateReaders(r->id, r->vBegin, slot);//drop the readers of the copy, prvReadResuming has restricted them
+    prvUnlockObjects(&r->id, 1);
+    DBEXIT_CRITICAL();
+
+    markCommit(slot);
+    prvResetWorking(slot);
+    prvFreePrevious(&r->previous, 1);
+    r->version = NULL;
+    r->state = RESUMEFREE;
+
+    return r->id;
 }
+#endif
 
 /*
- * description: free all allocated data, implemented for completeness and not used currently
- * parameters: none
+ * description: delete data objects which are not reachable by other tasks yet, e.g. the pages of a paged array whose page table is not committed
+ * parameters: ids of the data, number of the data
  * return: none
+ * note: an object is hidden before its versions are unlinked and freed, so a power failure leaks the versions instead of freeing them twice.
+ *       The ids are given back only if they are the last ones given out, in the order of creation, the others stay used like DBreserve
  * */
-void destructor(){
-    int i;
-    for(i = 0; i < NUMOBJ; i++){
-        if(DB[i].size > 0)
-            vPortFree(accessData(i));
+void DBdelete(int* ids, int num){
+    struct working w;
+    int k, age, id;
+#ifdef SHADOWSLOT
+    void* base;
+#else
+    void* version[NUMVERSION];
+#endif
+
+#ifdef GROUPCOMMIT
+    prvRetireStaged(pxCurrentTCB->taskID);//the objects may still be staged by the task
+#endif
+    for(k = num - 1; k >= 0; k--){
+        id = ids[k];
+        if(id < 0)
+            continue;
+        if(id >= NUMOBJ){//taken by a commit which ran out of objects
+            DBENTER_CRITICAL();
+            if(id == dataId - 1)
+                dataId--;
+            DBEXIT_CRITICAL();
+            continue;
+        }
+
+        //wait for the commits of others, e.g. DBcompact, to leave the object
+        w.id = id;
+        prvLockObjects(&w, 1);
+
+        DBENTER_CRITICAL();
+#ifdef DBCACHE
+        prvCacheDrop(id);
+#endif
+        DB[id].size = 0;//hidden from DBread
+        for(age = 0; age < READERWORDS; age++)
+            DB[id].readers[age] = 0;
+#ifdef SHADOWSLOT
+        base = accessBase(id);
+        DB[id].capacity = 0;
+#else
+        for(age = 0; age < NUMVERSION; age++)
+            version[age] = accessVersion(id, age);
+#endif
+        clearMaps(id);
+        if(id == dataId - 1)
+            dataId--;
+        prvUnlockObjects(&id, 1);
+        DBEXIT_CRITICAL();
+
+#ifdef SHADOWSLOT
+        if(base != NULL)
+            vPortFree(base);
+#else
+        for(age = 0; age < NUMVERSION; age++)
+            DBfree(&version[age]);
+#endif
     }
+#ifdef DBCACHE
+    prvCacheReap();
+#endif
 }
 
+#ifdef DBCOMPACT
 /*
- * description: create/write a data entry
- * parameters: source address of the data(max for 3 data commit atomically), size in terms of bytes
- * return: the id of the data, -1 for failure
- * note: currently support for committing one data object
+ * description: check if the version of the data can be in use by a task
+ * parameters: id of the data
+ * return: 1 if the data is leased or read by a running task, 0 otherwise
+ * note: should be called in critical sections
  * */
-int DBcommit(struct working *work, int size, int num){
-    int creation = 0,workId;
-    void* previous;
+static int prvInUse(int id){
+    int b;
 
-    /* creation or invalid ID */
-    if(work->id < 0){
-        work->id = dataId++;
-        creation = 1;
-    }
-    else//need to free it after commit
-        previous = accessData(work->id);
+    if(prvLeased(accessData(id)) >= 0)
+        return 1;
+    for(b = 0; b < NUMTASK; b++)
+        if(CHECK_BIT(DB[id].readers[b/16], b%16) && WSRValid[b] == 1 && DB[id].readGen[b] == WSRGen[b])
+            return 1;
+    return 0;
+}
 
-    if(work->id >= NUMOBJ)
-        return -1;
+/*
+ * description: relocate committed versions to lower addresses of the heap, so that the free space merges at the top
+ * parameters: maximum bytes to be moved
+ * return: bytes moved
+ * note: called by the idle hook with DBCOMPACT. A version being committed, leased or read by a running task is not moved,
+ *       and a moved version is published by the atomic switch of the maps with its validity interval unchanged
+ * */
+unsigned int DBcompact(unsigned int budget){
+    unsigned int moved = 0;
+    int n, id, busy;
+    unsigned long time;
 
-    workId = work->id;
-    taskENTER_CRITICAL();
+    for(n = 0; n < NUMOBJ; n++){
+        id = compactCursor;
+        compactCursor = (compactCursor + 1) % NUMOBJ;
 
-    int i,j;
-    /* Validation */
-    // for read set that have been updated after the read
-    for(j = 0; j < NUMTASK; j++){
-       if(WSRValid[j] > 0 && WSRTCB[j] == pxCurrentTCB->uxTCBNumber){
-           pxCurrentTCB->vEnd = min(pxCurrentTCB->vEnd,WSRBegin[j]-1);
-           WSRBegin[j] = 4294967295;//incase for a task with multiple commits
-           break;
-       }
-    }
+        //lock the object to keep writers away while it is moved
+        DBENTER_CRITICAL();
+        busy = (DB[id].size == 0 || DB[id].size > budget - moved || CHECK_BIT(commitLock[id/16], id%16) || prvInUse(id));
+        if(busy == 0)
+            commitLock[id/16] |= 1 << (id%16);
+        DBEXIT_CRITICAL();
+        if(busy)
+            continue;
 
-    // for write set:
-    if(creation == 0)
-        pxCurrentTCB->vBegin = max(pxCurrentTCB->vBegin, getBegin(workId)+1);
+        //versions of the size classes are not moved
+        if(DBslab(accessData(id))){
+            DBENTER_CRITICAL();
+            prvUnlockObjects(&id, 1);
+            DBEXIT_CRITICAL();
+            continue;
+        }
 
-    // should be finished no more later than current time
-    pxCurrentTCB->vEnd = min(pxCurrentTCB->vEnd, timeCounter);
+        //the copy is allocated into the record, so DBrecovery frees it after power failures
+        Compaction.id = id;
+        Compaction.from = accessData(id);
+        Compaction.to = NULL;
+        Compaction.state = COMPACTMOVING;
+        DBalloc(VERSIONSIZE(DB[id].size), &Compaction.to);
 
-    // validation fail
-    if(pxCurrentTCB->vBegin > pxCurrentTCB->vEnd){
-        taskEXIT_CRITICAL();
-        regTaskEnd();
-        taskRerun();
-        return -1;
+        //heap_4 takes the first fit from the lowest address, a higher block means no hole below the version.
+        //A block of the size classes takes the version out of the heap
+        if(Compaction.to == NULL || (!DBslab(Compaction.to) && Compaction.to > Compaction.from)){
+            DBfree(&Compaction.to);
+            Compaction.state = COMPACTIDLE;
+            DBENTER_CRITICAL();
+            prvUnlockObjects(&id, 1);
+            DBEXIT_CRITICAL();
+            continue;
+        }
+        DMAcopy(Compaction.to, Compaction.from, VERSIONSIZE(DB[id].size));//with the CRC32 if any
+
+        DBENTER_CRITICAL();
+        busy = prvInUse(id);//read or leased during the copy
+        if(busy == 0){
+            time = getCommitTime(id, 0);
+            commitGroup(1, &id, &Compaction.to, getBegin(id), getEnd(id));
+            setCommitTime(id, time);//a moved version keeps its place in snapshots
+            moved += DB[id].size;
+        }
+        prvUnlockObjects(&id, 1);
+        DBEXIT_CRITICAL();
+
+        //the unused copy is freed before the record is closed
+        if(busy)
+            DBfree(&Compaction.to);
+        else
+            DBfree(&Compaction.from);
+        Compaction.to = NULL;
+        Compaction.from = NULL;
+        Compaction.state = COMPACTIDLE;
     }
 
-    /* validation success, commit all changes*/
-    //working at VM, then write to a new space in NVM as consistent version
-    void* temp = (void*)pvPortMalloc(size);
-    memcpy(temp, work->address, size);
-    commit(workId,temp, pxCurrentTCB->vBegin, pxCurrentTCB->vEnd);
-    markCommit(pxCurrentTCB->taskID);
+    return moved;
+}
+#endif
 
-    /* Free the previous consistent data */
-    if(creation == 0)
-        vPortFree(previous);
+/*
+ * description: find an unused lease entry in a range of the entries
+ * parameters: first entry, end of the range
+ * return: index of the entry, -1 when all the leases of the range are in use
+ * note: should be called in critical sections
+ * */
+static int prvFreeLease(int first, int end){
+    int i;
 
-    /* Link the data */
-    DB[workId].size = size;
-    DB[workId].cacheAdd = work->address;
+    for(i = first; i < end; i++)
+        if(Leases[i].address == NULL)
+            return i;
+    return -1;
+}
 
-    /* validation: for those written data read by other tasks*/
-    // all write set's readers can be removed from readTCBNum[] after their valid interval is reduced
-    for(i = 0; i < MAXREAD; i++){
-        if(DB[workId].readTCBNum[i] != 0){
-            //no point to self-restricted
-            if(DB[workId].readTCBNum[i] == pxCurrentTCB->uxTCBNumber){
-                DB[workId].readTCBNum[i] = 0;
-                continue;
-            }
+/*
+ * description: record a lease so that a replaced version is not freed before it is released
+ * parameters: index of the lease entry, id of the data, task slot of the holder, pinned version
+ * return: none
+ * note: should be called in critical sections, the address is written last as it marks the entry used
+ * */
+static void prvPin(int i, int id, int slot, const void* address){
+    Leases[i].id = id;
+    Leases[i].slot = slot;
+    Leases[i].deferred = 0;
+    Leases[i].address = address;
+}
 
-            //search for valid, the task has read the written data
-            for(j = 0; j < NUMTASK; j++){
-                if(WSRValid[j] == 1 &&  WSRTCB[j] == DB[workId].readTCBNum[i]){
-                    WSRBegin[j] = min(pxCurrentTCB->vBegin,WSRBegin[j]);
-                    break;
-                }
+/*
+ * description: pin the version of the data as of a time by a snapshot pin of the current task, a version pinned by an earlier read is shared
+ * parameters: id of the data, time of the snapshot, set to 1 if a new pin is taken, 0 if the version is pinned already, -1 if the pins are used up
+ * return: read-only pointer of the data, NULL when the version is no longer kept or all the pins of the task are in use
+ * */
+static const void* prvPinAt(int id, unsigned long t, int* pinned){
+    const void* address = NULL;
+    const void* version;
+    int i, age, slot = pxCurrentTCB->taskID;
+
+    *pinned = 0;
+#ifdef UNDOLOG
+    prvEnterRead(id);
+#else
+    DBENTER_CRITICAL();
+#endif
+#ifdef DBCACHE
+    prvCacheDrop(id);//the cached commits are written back before the versions are searched
+#endif
+    for(age = 0; age < NUMVERSION; age++){
+        version = accessVersion(id, age);
+        if(version == NULL)
+            break;
+        if(getCommitTime(id, age) <= t){
+#ifdef SHADOWSLOT
+            //the inactive slot of a locked object is being written
+            if(CHECK_BIT(commitLock[id/16], id%16) && version == accessShadow(id))
+                break;
+#endif
+            address = version;
+            break;
+        }
+    }
+    if(address != NULL){
+        for(i = SNAPSHOTPINS(slot); i < SNAPSHOTPINS(slot) + MAXSNAPSHOT; i++)
+            if(Leases[i].address == address)
+                break;
+        if(i == SNAPSHOTPINS(slot) + MAXSNAPSHOT){
+            i = prvFreeLease(SNAPSHOTPINS(slot), SNAPSHOTPINS(slot) + MAXSNAPSHOT);
+            if(i >= 0){
+                prvPin(i, id, slot, address);
+                *pinned = 1;
+            }
+            else{
+                address = NULL;
+                *pinned = -1;
             }
-            DB[workId].readTCBNum[i] = 0;// configure for write set's readers
         }
     }
+    DBEXIT_CRITICAL();
+
+    return address;
+}
+
+/*
+ * description: release a pin of the current task in a range of the lease entries, the version is freed if it has been replaced and no other lease pins it
+ * parameters: first entry, end of the range, pinned version
+ * return: none
+ * */
+static void prvUnpin(int first, int end, const void* address){
+    int i, deferred = 0;
+
+    if(address == NULL)
+        return;
+
+    DBENTER_CRITICAL();
+    for(i = first; i < end; i++){
+        if(Leases[i].address == address && Leases[i].slot == pxCurrentTCB->taskID){
+            deferred = Leases[i].deferred;
+            Leases[i].address = NULL;
+            break;
+        }
+    }
+    if(deferred && prvLeased(address) >= 0)//still pinned by others
+        deferred = 0;
+    DBEXIT_CRITICAL();
+
+    if(deferred)
+        DBfree((void**)&address);
+}
+
+/*
+ * description: pin the version in the snapshot of a read-only task, the snapshot moves to the last tick until the first read
+ * parameters: id of the data, set to 1 if a new pin is taken, 0 if the version is pinned by an earlier read
+ * return: read-only pointer of the data, NULL when all the MAXSNAPSHOT pins of the task are in use
+ * note: the task is rerun with a new snapshot only if the version is no longer kept, the pins are held until the run ends
+ * */
+static const void* prvSnapshotRead(int id, int* pinned){
+    int slot = pxCurrentTCB->taskID;
+    const void* address;
+
+    if(ReadOnlyRead[slot] == 0)
+        ReadOnlyTime[slot] = DBsnapshotBegin(timeCounter);
+    address = prvPinAt(id, ReadOnlyTime[slot], pinned);
+    if(address == NULL && *pinned == -1)//a rerun would not free any pin
+        return NULL;
+    if(address == NULL){
+#ifdef DBPROFILE
+        DBabortCount++;
+#endif
+        regTaskEnd();
+        taskRerun();
+    }
+    ReadOnlyRead[slot] = 1;
 
-    taskEXIT_CRITICAL();
-    return workId;
+    return address;
 }
 
 /*
  * description: return the address of a data copy of the data object
  * parameters: id of the data
  * return: the pointer of data, NULL for failure
+ * note: the version read by a read-only task is pinned until the task registers again or unregisters
  * */
 void* DBread(int id){
 
-    if(id > NUMOBJ || id < 0 || DB[id].size <= 0)
+    int pinned;
+
+    prvCheckDoomed();
+    if(id >= NUMOBJ || id < 0 || DB[id].size <= 0)
         return NULL;
+    else if(ReadOnly[pxCurrentTCB->taskID])
+        return (void*)prvSnapshotRead(id, &pinned);
     else{
-        /* Validation: save the reader's TCBNumber for committing tasks */
-        int i;
-        //can use Mutex for efficiency
-        taskENTER_CRITICAL();
-        for(i = 0; i < MAXREAD; i++)
-            if(DB[id].readTCBNum[i] == pxCurrentTCB->uxTCBNumber){
-                i = -1;
-                break;//already in the list
-            }
-        if(i != -1)
-            for(i = 0; i < MAXREAD; i++){
-                if(DB[id].readTCBNum[i] == 0){
-                    DB[id].readTCBNum[i] = pxCurrentTCB->uxTCBNumber;//put it to the list
-                    break;
-                }
-            }
-        taskEXIT_CRITICAL();
-
-        if(DB[id].cacheAdd != NULL){
+        /* Validation: mark the reader's task slot for committing tasks */
+        int slot = pxCurrentTCB->taskID;
+        void* cached;
+#ifdef DBCACHE
+        prvCacheAdmit(id);
+#endif
+#ifdef UNDOLOG
+        prvEnterRead(id);
+#else
+        DBENTER_CRITICAL();
+#endif
+        DB[id].readers[slot/16] |= 1 << (slot%16);
+        DB[id].readGen[slot] = WSRGen[slot];
+#if defined(UNDOLOG) || defined(DBCACHE)
+        HoldsPointer[slot] = 1;
+#endif
+#ifdef GROUPCOMMIT
+        prvReadStaged(id, slot);
+#endif
+#ifdef DBRESUME
+        prvReadResuming(id, slot);
+#endif
+        cached = DB[id].cacheAdd;//a copy may be evicted once the task leaves the critical section
+        if(cached != NULL)
             accessCache(id);
-            return DB[id].cacheAdd;
-        }
+        DBEXIT_CRITICAL();
+
+#if defined(DBCACHE) && defined(DBPROFILE)
+        if(cached != NULL)
+            DBcacheHits++;
+        else
+            DBcacheMisses++;
+#endif
+        if(cached != NULL)
+            return cached;
         else/* Return the data */
             return access(id);
     }
@@ -282,11 +2556,183 @@ void* DBread(int id){
 /*
  * description: read the data from memory
  * parameters: read to where, id of the data
- * return:
+ * return: the id of the data, -1 for failure
+ * */
+int DBreadIn(void* to,int id){
+    const void* from;
+    int pinned, slot = pxCurrentTCB->taskID;
+#if defined(UNDOLOG) || defined(DBCACHE)
+    unsigned char held = HoldsPointer[slot];
+#endif
+
+    if(ReadOnly[slot] && id < NUMOBJ && id >= 0 && DB[id].size > 0){
+        //the snapshot is fixed by the first read, so a new pin is only needed for the copy
+        from = prvSnapshotRead(id, &pinned);
+        if(from == NULL)
+            return -1;
+        DMAcopy(to, (void*)from, DB[id].size);
+        if(pinned == 1)
+            prvUnpin(SNAPSHOTPINS(slot), SNAPSHOTPINS(slot) + MAXSNAPSHOT, from);
+        return id;
+    }
+#if defined(UNDOLOG) || defined(DBCACHE)
+    //the pointer is only held during the copy, an in-place commit in between dooms the task
+    from = DBread(id);
+    if(from != NULL)
+        DMAcopy(to, (void*)from, DB[id].size);
+    HoldsPointer[slot] = held;
+#else
+    from = DBread(id);
+    if(from != NULL)
+        DMAcopy(to, (void*)from, DB[id].size);
+#endif
+    return (from != NULL)? id : -1;
+}
+
+/*
+ * description: rerun the current task at once if it cannot commit anymore, called at checkpoints of long computations
+ * parameters: none
+ * return: 0 if the task can still commit, -1 if the transaction of the task is doomed, otherwise the task is deleted and rerun
+ * note: a doomed transaction is not aborted here, it fails at DBtxCommit and is retried from DBtxBegin
+ * */
+int DBvalidate(){
+    int doomed, slot = pxCurrentTCB->taskID;
+
+    DBENTER_CRITICAL();
+    doomed = Doomed[slot] || prvCollapsed();
+    if(doomed)
+        Doomed[slot] = 1;
+    DBEXIT_CRITICAL();
+    if(doomed && InTx[slot])
+        return -1;
+    if(doomed)
+        prvAbort();
+    return 0;
+}
+
+/*
+ * description: mark the task being switched in if it cannot commit anymore, it is rerun at its next data manager call
+ * parameters: none
+ * return: none
+ * note: called by the tick interrupt with DBEARLYABORT, a task cannot be deleted in interrupts
+ * */
+void DBtickValidate(){
+    int slot = pxCurrentTCB->taskID;
+
+    if(slot >= 0 && slot < NUMTASK && prvCollapsed())
+        Doomed[slot] = 1;
+}
+
+/*
+ * description: release all the leases held by a task slot
+ * parameters: task slot
+ * return: none
+ * */
+static void prvReleaseLeases(int slot){
+    int i;
+
+    for(i = 0; i < LEASEENTRIES; i++)
+        if(Leases[i].address != NULL && Leases[i].slot == slot)
+            prvUnpin(i, i + 1, Leases[i].address);
+}
+
+/*
+ * description: pin the consistent version of the data and return it without copying
+ * parameters: id of the data
+ * return: read-only pointer of the data, NULL for failure or when all the leases are in use
+ * note: the version stays valid until DBleaseEnd even if the data is committed by others,
+ *       with SHADOWSLOT a task should end its lease before it commits the same data twice,
+ *       a read-only task shares the snapshot pins of its reads which are held until the run ends
+ * */
+const void* DBleaseBegin(int id){
+    const void* address = NULL;
+    int i, pinned, slot = pxCurrentTCB->taskID;
+
+    prvCheckDoomed();
+    if(id >= NUMOBJ || id < 0 || DB[id].size <= 0)
+        return NULL;
+    if(ReadOnly[slot])
+        return prvSnapshotRead(id, &pinned);
+
+#ifdef UNDOLOG
+    prvEnterRead(id);
+#else
+    DBENTER_CRITICAL();
+#endif
+    i = prvFreeLease(0, MAXLEASE);
+    if(i >= 0){
+        /* Validation: mark the reader's task slot for committing tasks */
+        DB[id].readers[slot/16] |= 1 << (slot%16);
+        DB[id].readGen[slot] = WSRGen[slot];
+#ifdef GROUPCOMMIT
+        prvReadStaged(id, slot);
+#endif
+#ifdef DBRESUME
+        prvReadResuming(id, slot);
+#endif
+#ifdef DBCACHE
+        prvCacheDrop(id);//the version in FRAM is pinned
+#endif
+        address = access(id);
+#ifdef SHADOWSLOT
+        //the inactive slot of a locked object is being written
+        if(CHECK_BIT(commitLock[id/16], id%16) && address == accessShadow(id))
+            address = NULL;
+#endif
+        if(address != NULL)
+            prvPin(i, id, slot, address);
+    }
+    DBEXIT_CRITICAL();
+
+    return address;
+}
+
+/*
+ * description: release a read lease, the version is freed if it has been replaced and no other lease pins it
+ * parameters: pointer returned by DBleaseBegin
+ * return: none
+ * */
+void DBleaseEnd(const void* address){
+    //snapshot pins may be shared by several reads, they are released by DBsnapshotEnd or at the end of the run
+    prvUnpin(0, MAXLEASE, address);
+}
+
+/*
+ * description: start a snapshot of all the data as of a time, snapshot reads neither register the task nor abort it
+ * parameters: time of the snapshot
+ * return: time used by DBreadAt, clamped to the last finished tick as commits may still be published in the current tick
+ * */
+unsigned long DBsnapshotBegin(unsigned long t){
+    unsigned long now = timeCounter;
+
+    prvCheckDoomed();
+    if(t >= now)
+        t = (now > 0)? now - 1 : 0;
+    return t;
+}
+
+/*
+ * description: pin the version of the data which is current as of the snapshot time and return it without copying
+ * parameters: id of the data, time returned by DBsnapshotBegin
+ * return: read-only pointer of the data, NULL when the version is no longer kept or all the MAXSNAPSHOT pins of the task are in use
+ * note: the version is pinned until DBsnapshotEnd, reads with the same time are consistent across objects and the reads of
+ *       the same version share a pin. Only the latest version is kept when NUMVERSION is 2, set NUMVERSION > 2 to read older snapshots
+ * */
+const void* DBreadAt(int id, unsigned long t){
+    int pinned;
+
+    if(id >= NUMOBJ || id < 0 || DB[id].size <= 0)
+        return NULL;
+    return prvPinAt(id, t, &pinned);
+}
+
+/*
+ * description: end the snapshot and release all the versions pinned by DBreadAt
+ * parameters: none
+ * return: none
  * */
-void DBreadIn(void* to,int id){
-    //TODO: range of id needs to be checked here
-    memcpy(to, DBread(id), DB[id].size);
+void DBsnapshotEnd(){
+    prvReleaseLeases(pxCurrentTCB->taskID);
 }
 
 /*
@@ -296,38 +2742,208 @@ void DBreadIn(void* to,int id){
  * */
 void DBworking(struct working* wIn, int id)
 {
-    if(id >= 0 && id < 16)
-        wIn->address = &Working[pxCurrentTCB->taskID][id];
+    if(id >= 0 && id < NUMOBJ && DB[id].size > 0)
+        DBworkingSize(wIn, id, DB[id].size, LOCVM);
     else
-        wIn->address = &Working[pxCurrentTCB->taskID][16];//default for creation
+        DBworkingSize(wIn, id, sizeof(long), LOCVM);//default for creation
+    wIn->size = 0;
+
+    return;
+}
+
+/*
+ * description: return a working space of any size for the task, the space is valid until the task commits or registers again
+ * parameters: data structure of working space, id of the data, size of the required data, LOCVM/LOCNVM for SRAM/FRAM
+ * return: none, wIn->address is NULL for failure
+ * note: a working space which does not fit in the SRAM arena is allocated from the FRAM arena, and wIn->loc tells where it is
+ * */
+void DBworkingSize(struct working* wIn, int id, int size, int loc)
+{
+    int taskID = pxCurrentTCB->taskID;
+    unsigned int aligned = (size + 1) & ~1;//keep working spaces word aligned
+
+    prvCheckDoomed();
     wIn->id = id;
+    wIn->size = size;
+    if(loc == LOCVM && WorkingVMIndex[taskID] + aligned <= WORKSRAMSIZE){
+        wIn->address = &WorkingVM[taskID][WorkingVMIndex[taskID]];
+        wIn->loc = LOCVM;
+        WorkingVMIndex[taskID] += aligned;
+    }
+    else if(WorkingNVMIndex[taskID] + aligned <= WORKNVMSIZE){
+        wIn->address = &WorkingNVM[taskID][WorkingNVMIndex[taskID]];
+        wIn->loc = LOCNVM;
+        WorkingNVMIndex[taskID] += aligned;
+    }
+    else
+        wIn->address = NULL;
 
     return;
 }
 
+/*
+ * description: start a new validity interval of the current task, the previous reads and working spaces are dropped
+ * parameters: task slot
+ * return: none
+ * */
+static void prvBeginInterval(int slot){
+    //initialize the TCB's validity interval
+    pxCurrentTCB->vBegin = 0;
+    pxCurrentTCB->vEnd = 4294967295;
+    prvResetWorking(slot);
+    //register the current TCB to the DB, a new generation makes the previous reads of the slot stale
+    DBENTER_CRITICAL();
+    WSRTCB[slot] = pxCurrentTCB->uxTCBNumber;
+    WSRBegin[slot] = 4294967295;
+    WSRGen[slot]++;
+    WSRValid[slot] = 1;
+    Doomed[slot] = 0;
+#if defined(UNDOLOG) || defined(DBCACHE)
+    HoldsPointer[slot] = 0;
+#endif
+    DBEXIT_CRITICAL();
+}
+
+/*
+ * description: start a transaction of the current task, which is retried from here if DBtxCommit fails
+ * parameters: transaction handle
+ * return: none
+ * note: a task can run many transactions in a registration, the previous transaction has to be committed or aborted
+ * */
+void DBtxBegin(struct transaction* tx){
+    int slot = pxCurrentTCB->taskID;
+
+#ifdef GROUPCOMMIT
+    prvRetireStaged(slot);//the writes of the previous transaction are visible from now on
+#endif
+    prvBeginInterval(slot);
+    tx->num = 0;
+    InTx[slot] = 1;
+}
+
+/*
+ * description: read the data in a transaction, the writes of the transaction are read back
+ * parameters: transaction handle, id of the data
+ * return: read-only pointer of the data, NULL for failure
+ * */
+const void* DBtxRead(struct transaction* tx, int id){
+    int k;
+
+    for(k = 0; k < tx->num; k++)
+        if(id >= 0 && tx->work[k].id == id)
+            return tx->work[k].address;
+    return DBread(id);
+}
+
+/*
+ * description: return the working space to write the data in a transaction, it is committed by DBtxCommit
+ * parameters: transaction handle, id of the data (-1 to create one), size of the data (0 for the current size)
+ * return: the working space, the same one for the same data, NULL when the write set is full or out of working spaces
+ * note: the working space is not initialized, read the data by DBtxRead first to update it
+ * */
+void* DBtxWrite(struct transaction* tx, int id, int size){
+    int k;
+
+    if(id >= NUMOBJ)
+        return NULL;
+    for(k = 0; k < tx->num; k++)
+        if(id >= 0 && tx->work[k].id == id)
+            return tx->work[k].address;
+    if(tx->num >= MAXCOMMIT)
+        return NULL;
+    if(size <= 0 && id >= 0)
+        size = DB[id].size;
+    if(size <= 0)
+        return NULL;
+
+    DBworkingSize(&tx->work[tx->num], id, size, LOCVM);
+    if(tx->work[tx->num].address == NULL)
+        return NULL;
+    return tx->work[tx->num++].address;
+}
+
+/*
+ * description: validate the transaction and commit its write set atomically
+ * parameters: transaction handle
+ * return: 0 for success, -1 if the transaction has to be retried from DBtxBegin
+ * note: ids of the created data are returned in tx->work[i].id
+ * */
+int DBtxCommit(struct transaction* tx){
+    int result, slot = pxCurrentTCB->taskID;
+
+    if(tx->num == 0){//read only, the reads are consistent if the interval is not empty
+        DBENTER_CRITICAL();
+        result = (Doomed[slot] || prvCollapsed())? -1 : 0;
+        DBEXIT_CRITICAL();
+    }
+    else if(Doomed[slot])//doomed by DBvalidate or by a writer
+        result = -1;
+    else
+        result = (DBcommit(tx->work, 0, tx->num) < 0)? -1 : 0;
+
+    prvResetWorking(slot);
+    tx->num = 0;
+    InTx[slot] = 0;
+    return result;
+}
+
+/*
+ * description: give up the transaction, its working spaces are dropped
+ * parameters: transaction handle
+ * return: none
+ * */
+void DBtxAbort(struct transaction* tx){
+    int slot = pxCurrentTCB->taskID;
+
+    prvResetWorking(slot);
+    tx->num = 0;
+    InTx[slot] = 0;
+}
+
+/*
+ * description: declare the current task read-only after registerTCB, its reads are served from a snapshot without
+ *              registering it as a reader, so that committing tasks do not restrict it and it is never invalidated
+ * parameters: none
+ * return: none
+ * note: DBcommit fails for a read-only task until it registers again
+ * */
+void DBreadOnly(){
+    int slot = pxCurrentTCB->taskID;
+
+    ReadOnlyRead[slot] = 0;
+    ReadOnly[slot] = 1;
+}
+
 /*
  * description: start the concurrency control of the current task, this function will register the current TCB to the DB, and initialize the TCB's validity interval
  * parameters: the TCB number
  * return: none
  * */
 void registerTCB(int id){
-    int i;
-    unsigned short TCB = pxCurrentTCB->uxTCBNumber;
+    int slot = pxCurrentTCB->taskID;
 
-    //initialize the TCB's validity interval
-    pxCurrentTCB->vBegin = 0;
-    pxCurrentTCB->vEnd = 4294967295;
-    //register the current TCB to the DB,
-    for(i = 0; i < NUMTASK; i++){
-        if(!WSRValid[i]){
-            WSRTCB[i] = TCB;
-            WSRBegin[i] = 4294967295;
-            WSRValid[i] = 1;
-            return;
-        }
+    ( void ) id;//the slot is given by the TCB
+
+#ifdef GROUPCOMMIT
+    prvRetireStaged(slot);
+#endif
+    //a rerun task may leave its leases behind
+    prvReleaseLeases(slot);
+    //the same TCB registers again for its next run, a rerun has a new TCB
+    if(WSRValid[slot] && WSRTCB[slot] == pxCurrentTCB->uxTCBNumber)
+        RunGen[slot]++;
+#ifdef DBRESUME
+    //the commits of DBcommitLarge are numbered from the start of each attempt
+    Resumes[slot].calls = 0;
+    if(Resumes[slot].run != RunGen[slot]){
+        Resumes[slot].run = RunGen[slot];
+        Resumes[slot].done = 0;
     }
-    //should not be here
-    //TODO: error handling
+#endif
+
+    ReadOnly[slot] = 0;
+    InTx[slot] = 0;
+    prvBeginInterval(slot);
 }
 
 
@@ -338,17 +2954,19 @@ void registerTCB(int id){
  * */
 void unresgisterTCB(int id)
 {
-    int i;
-    unsigned short TCB = pxCurrentTCB->uxTCBNumber;
-    for(i = 0; i < NUMTASK; i++){
-        if(WSRValid[i]){
-            if(WSRTCB[i] == TCB){
-                WSRValid[i] = 0;
-                return;
-            }
+    int slot = pxCurrentTCB->taskID;
+
+    ( void ) id;//the slot is given by the TCB
+
+    //a stale TCB number means the slot has been registered by a rerun of the task
+    if(WSRValid[slot] && WSRTCB[slot] == pxCurrentTCB->uxTCBNumber){
+        WSRValid[slot] = 0;
+        RunGen[slot]++;
+        if(ReadOnly[slot]){
+            prvReleaseLeases(slot);
+            ReadOnly[slot] = 0;
         }
     }
-    //TODO: error handling
 }
 
 
@@ -362,6 +2980,36 @@ void* getStackVM(int taskID)
     return &StacksVM[STATICSTACKVMSIZE*taskID];
 }
 
+/*
+ * description: get the task slot of the current task
+ * parameters: none
+ * return: the task ID
+ * */
+int getTaskID()
+{
+    return pxCurrentTCB->taskID;
+}
+
+/*
+ * description: get the number of runs finished by the task slot
+ * parameters: task ID
+ * return: the number of runs, which stays the same for the reruns of a run
+ * */
+unsigned int getRunGen(int taskID)
+{
+    return RunGen[taskID];
+}
+
+/*
+ * description: get the generation of the registration of the task slot
+ * parameters: task ID
+ * return: the generation, bumped by every registerTCB including the ones of reruns
+ * */
+unsigned char getRegisterGen(int taskID)
+{
+    return WSRGen[taskID];
+}
+
 /*
  * description: get the TCB allocated for the task
  * parameters: task ID
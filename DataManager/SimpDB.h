@@ -3,64 +3,124 @@
  *
  *  Description: This simple DB is used to manage data and task snapshot(stacks)
  */
+
+#ifndef DATAMANAGER_SIMPDB_H_
+#define DATAMANAGER_SIMPDB_H_
+
 #include <../DataManager/maps.h>
 #include <FreeRTOSConfig.h>
 #include <stdint.h>
 #include <config.h>
 
-#define TOTAL_DATA_SIZE 16 * NUMOBJ
-#define DWORKSIZE NUMTASK*(NUMOBJ+1)*4 //every one (even for the creation) for a word for now; TODO: better utilization is needed
+#define TOTAL_DATA_SIZE (sizeof(struct data) * NUMOBJ)
 
 #define STATICSTACKVMSIZE 400
 
-// used for validation: Task t with Task's TCB = WSRTCB[i], SRBegin[NUMTASK] = min(writer's begin), WSRValid[NUMTASK] = 1
-static unsigned long WSRBegin[NUMTASK]; //The "begin time of every commit operation" for an object "read by task i" is saved in WSRBegin[i]
-static unsigned short WSRTCB[NUMTASK];
-static unsigned char WSRValid[NUMTASK];
+#define READERWORDS ((NUMTASK+15)/16) //one bit for each task slot
+
+#ifdef DBCRC
+#define CRCOFFSET(size) (((size) + 1) & ~1) //the CRC32 follows the data of each version, word aligned
+#define VERSIONSIZE(size) (CRCOFFSET(size) + sizeof(uint32_t))
+extern unsigned long DBcrcFailures;
+#else
+#define VERSIONSIZE(size) (size)
+#endif
+
+#define LOCNVM 0
+#define LOCVM 1
 
-struct working{//working space of data for tasks
+struct working{//working space of data for tasks, given in FRAM (LOCNVM) if it does not fit in the SRAM arena, e.g. DBworking of a data larger than WORKSRAMSIZE
     void* address;
     int loc;//1 stands for SRAM, 0 stands for@NVM
     int id;//-1 for create
+    int size;//size to commit in bytes, 0 for using the size given to DBcommit
+};
+
+struct transaction{//read/write set of DBtx*, committed atomically by DBtxCommit
+    int num;//number of the written data
+    struct working work[MAXCOMMIT];
 };
 
 struct data{//two-version data structure
     void* cacheAdd;//Should point to VM or NVM(depends on mode)
     unsigned int size;
-    unsigned short readTCBNum[MAXREAD];//store 5 readers' TCB number
+    unsigned int capacity;//size of each preallocated version, used for SHADOWSLOT
+    unsigned int readers[READERWORDS];//bit i is set if the task in slot i has read the data
+    unsigned char readGen[NUMTASK];//generation of the reader in slot i, a reader of an older generation is stale
 };
 
 /* for validation */
 extern unsigned long timeCounter;
 
-#pragma NOINIT(DBSpace) //space for maintaining data structure of data
-static uint8_t DBSpace[TOTAL_DATA_SIZE];
-
-#pragma NOINIT(DB) //data structures for all data
-static struct data* DB;
-
-#pragma DATA_SECTION(dataId, ".map") //id for data labeling
-static int dataId;
+/* critical sections of the data manager, DBPROFILE accumulates the time with interrupts disabled by the outermost ones */
+#ifdef DBPROFILE
+extern unsigned int criticalStart;
+extern unsigned int criticalDepth;
+extern unsigned long DBcriticalCycles;
+extern unsigned long DBcriticalCount;
+extern unsigned int DBcriticalMax;
+extern unsigned long DBcommitCount;
+extern unsigned long DBabortCount;
+extern unsigned long DBearlyAbortCount;
+extern unsigned long DBbatchCount;
+extern unsigned long DBcrcCycles;
+extern unsigned long DBverifyCycles;
+extern unsigned long DBverifyBytes;
+extern unsigned long DBwriteBytes;
+extern unsigned long DBelideCount;
+extern unsigned long DBcoalesceCount;
+extern unsigned long DBcacheHits;
+extern unsigned long DBcacheMisses;
+extern unsigned long DBflushCount;
+void DBprofileCritical();
+#define DBENTER_CRITICAL() do{ taskENTER_CRITICAL(); if(criticalDepth++ == 0) criticalStart = TB0R; }while(0)
+#define DBEXIT_CRITICAL() do{ if(--criticalDepth == 0) DBprofileCritical(); taskEXIT_CRITICAL(); }while(0)
+#else
+#define DBENTER_CRITICAL() taskENTER_CRITICAL()
+#define DBEXIT_CRITICAL() taskEXIT_CRITICAL()
+#endif
 
 /* Functions to access and maintain data objects */
 void constructor();
 void destructor();
+void DBrecovery();
+int DBreserve();
+void DBdelete(int* ids, int num);
 int DBcommit(struct working *work, int size, int num);
+int DBcommitLarge(struct working *work, int size);
 void* DBread(int id);
-void DBreadIn(void* to,int id);
+int DBreadIn(void* to,int id);
+int DBvalidate();
+void DBtickValidate();
+void DBpublish();
+void DBcacheFlush();
+void DBcacheResume();
+unsigned int DBcompact(unsigned int budget);
+const void* DBleaseBegin(int id);
+void DBleaseEnd(const void* address);
+unsigned long DBsnapshotBegin(unsigned long t);
+const void* DBreadAt(int id, unsigned long t);
+void DBsnapshotEnd();
 void DBworking(struct working* wIn, int id);
+void DBworkingSize(struct working* wIn, int id, int size, int loc);
+void DBtxBegin(struct transaction* tx);
+const void* DBtxRead(struct transaction* tx, int id);
+void* DBtxWrite(struct transaction* tx, int id, int size);
+int DBtxCommit(struct transaction* tx);
+void DBtxAbort(struct transaction* tx);
 void * getStackVM(int taskID);
 void * getTCBVM(int taskID);
+int getTaskID();
+unsigned int getRunGen(int taskID);
+unsigned char getRegisterGen(int taskID);
 
 /* functions for validation*/
 void registerTCB(int id);
+void DBreadOnly();
 void unresgisterTCB(int id);
+unsigned long getTaskEnd();
 
 /* internal functions */
-static unsigned long min(unsigned long a, unsigned long b){
-    if (a > b)
-        return b;
-    else
-        return a;
-}
+unsigned long min(unsigned long a, unsigned long b);
 
+#endif /* DATAMANAGER_SIMPDB_H_ */
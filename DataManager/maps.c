@@ -104,6 +104,67 @@ typedef struct tskTaskControlBlock
 } tskTCB;
 
 extern tskTCB * volatile pxCurrentTCB;
+extern unsigned long timeCounter;
+unsigned long getTaskEnd();//defined by SimpDB.c
+
+/* internal functions */
+unsigned long max(unsigned long a, unsigned long b){
+    if (a > b)
+        return a;
+    else
+        return b;
+}
+
+#if NUMVERSION > 2
+#pragma DATA_SECTION(versionHead, ".map") //index of the latest version of each object in its ring
+static int versionHead[NUMOBJ];
+
+/* Protected data for atomicity, the versions of an object are ordered by validBegin along its ring */
+#pragma NOINIT(mapRing)
+static void* mapRing[NUMVERSION][NUMOBJ];
+#pragma NOINIT(validBeginRing)
+static unsigned long validBeginRing[NUMVERSION][NUMOBJ];//NEVERVALID for a slot without any committed version
+#pragma NOINIT(validEndRing)
+static unsigned long validEndRing[NUMVERSION][NUMOBJ];
+#pragma NOINIT(commitTimeRing)
+static unsigned long commitTimeRing[NUMVERSION][NUMOBJ];//timeCounter when the version is published
+
+#define NEVERVALID 4294967295
+#define OLDEST(numObj) ((versionHead[numObj] + 1) % NUMVERSION)
+#define OLDER(v) (((v) + NUMVERSION - 1) % NUMVERSION)
+#else
+#pragma DATA_SECTION(mapSwitcher, ".map") //each bit indicates address map for a object
+static int mapSwitcher[SWITCHERWORDS];
+
+/* Protected data for atomicity */
+#pragma NOINIT(map0)
+static void* map0[NUMOBJ];
+#pragma NOINIT(validBegin0)
+static unsigned long validBegin0[NUMOBJ];
+#pragma NOINIT(validEnd0)
+static unsigned long validEnd0[NUMOBJ];
+#pragma NOINIT(commitTime0)
+static unsigned long commitTime0[NUMOBJ];//timeCounter when the version is published
+
+#pragma NOINIT(map1)
+static void* map1[NUMOBJ];
+#pragma NOINIT(validBegin1)
+static unsigned long validBegin1[NUMOBJ];
+#pragma NOINIT(validEnd1)
+static unsigned long validEnd1[NUMOBJ];
+#pragma NOINIT(commitTime1)
+static unsigned long commitTime1[NUMOBJ];
+#endif
+
+/* Redo record for a group commit touching more than one word of mapSwitcher, or more than one versionHead with NUMVERSION > 2 */
+struct switchRecord{
+    int valid;//1: the new words should be applied
+    int num;
+    int word[MAXGROUP];//index of mapSwitcher or versionHead
+    int value[MAXGROUP];
+};
+#pragma DATA_SECTION(switchLog, ".map")
+static struct switchRecord switchLog;
 
 /*
  * description: reset all the mapSwitcher and maps
@@ -111,15 +172,32 @@ extern tskTCB * volatile pxCurrentTCB;
  * return: none
  * */
  void init(){
-    memset(mapSwitcher, 0, sizeof(unsigned int) * NUMCOMMIT);
+#if NUMVERSION > 2
+    int v, i;
+#endif
+
+    switchLog.valid = 0;
+#if NUMVERSION > 2
+    memset(versionHead, 0, sizeof(versionHead));
+    memset(mapRing, 0, sizeof(mapRing));
+    memset(validEndRing, 0, sizeof(validEndRing));
+    memset(commitTimeRing, 0, sizeof(commitTimeRing));
+    for(v = 0; v < NUMVERSION; v++)
+        for(i = 0; i < NUMOBJ; i++)
+            validBeginRing[v][i] = NEVERVALID;
+#else
+    memset(mapSwitcher, 0, sizeof(mapSwitcher));
 
     memset(map0, 0, sizeof(void*) * NUMOBJ);
     memset(validBegin0, 0, sizeof(unsigned long) * NUMOBJ);
     memset(validEnd0, 0, sizeof(unsigned long) * NUMOBJ);
+    memset(commitTime0, 0, sizeof(unsigned long) * NUMOBJ);
 
     memset(map1, 0, sizeof(void*) * NUMOBJ);
     memset(validBegin1, 0, sizeof(unsigned long) * NUMOBJ);
     memset(validEnd1, 0, sizeof(unsigned long) * NUMOBJ);
+    memset(commitTime1, 0, sizeof(unsigned long) * NUMOBJ);
+#endif
 }
 
  /*
@@ -128,11 +206,15 @@ extern tskTCB * volatile pxCurrentTCB;
   * return: none
   * */
 void accessCache(int numObj){
+#if NUMVERSION > 2
+    pxCurrentTCB->vBegin = max(pxCurrentTCB->vBegin, validBeginRing[versionHead[numObj]][numObj]+1);
+#else
     int prefix = numObj/16,postfix = numObj%16;
     if(CHECK_BIT(mapSwitcher[prefix], postfix) > 0)
         pxCurrentTCB->vBegin = max(pxCurrentTCB->vBegin, validBegin1[numObj]+1);
     else
         pxCurrentTCB->vBegin = max(pxCurrentTCB->vBegin, validBegin0[numObj]+1);
+#endif
     return;
 }
 
@@ -140,8 +222,25 @@ void accessCache(int numObj){
  * description: return the address for the commit data, reduce the valid interval
  * parameters: number of the object
  * return: none
+ * note: with NUMVERSION > 2, the latest version that can be valid before the end of the task's interval (getTaskEnd) is returned,
+ *       and the task is serialized before the successor of the version
  * */
 void* access(int numObj){
+#if NUMVERSION > 2
+    int i, v = versionHead[numObj], succ = -1;
+    unsigned long end = getTaskEnd();//the commits to the data read before are not folded into vEnd yet
+
+    for(i = 1; i < NUMVERSION && validBeginRing[v][numObj] >= end; i++){
+        if(validBeginRing[OLDER(v)][numObj] >= validBeginRing[v][numObj])//no older version
+            break;
+        succ = v;
+        v = OLDER(v);
+    }
+    pxCurrentTCB->vBegin = max(pxCurrentTCB->vBegin, validBeginRing[v][numObj]+1);
+    if(succ >= 0 && pxCurrentTCB->vEnd > validBeginRing[succ][numObj]-1)
+        pxCurrentTCB->vEnd = validBeginRing[succ][numObj]-1;
+    return mapRing[v][numObj];
+#else
     int prefix = numObj/16,postfix = numObj%16;
     if(CHECK_BIT(mapSwitcher[prefix], postfix) > 0){
         pxCurrentTCB->vBegin = max(pxCurrentTCB->vBegin, validBegin1[numObj]+1);
@@ -151,6 +250,7 @@ void* access(int numObj){
         pxCurrentTCB->vBegin = max(pxCurrentTCB->vBegin, validBegin0[numObj]+1);
         return map0[numObj];
     }
+#endif
 }
 
 volatile int dummy;// the compiler mess up something which will skip compiling the CHECK_BIT procedure, we need this to make the if/else statement work!
@@ -160,6 +260,9 @@ volatile int dummy;// the compiler mess up something which will skip compiling t
  * return: none
  * */
 void* accessData(int numObj){
+#if NUMVERSION > 2
+    return mapRing[versionHead[numObj]][numObj];
+#else
     int prefix = numObj/16,postfix = numObj%16;
     if(CHECK_BIT(mapSwitcher[prefix], postfix) > 0){
         dummy = 1;
@@ -169,6 +272,152 @@ void* accessData(int numObj){
         dummy = 0;
         return map0[numObj];
     }
+#endif
+}
+
+/*
+ * description: return the address for the inactive version, which is overwritten by the next commit
+ * parameters: number of the object
+ * return: the address of the inactive version, the oldest one of the ring with NUMVERSION > 2
+ * */
+void* accessShadow(int numObj){
+#if NUMVERSION > 2
+    return mapRing[OLDEST(numObj)][numObj];
+#else
+    int prefix = numObj/16,postfix = numObj%16;
+    if(CHECK_BIT(mapSwitcher[prefix], postfix) > 0){
+        dummy = 1;
+        return map0[numObj];
+    }
+    else{
+        dummy = 0;
+        return map1[numObj];
+    }
+#endif
+}
+
+/*
+ * description: return the address of an older committed version
+ * parameters: number of the object, number of the versions committed after it (0 for the latest version)
+ * return: the address of the version, NULL if it is not kept
+ * note: only the latest version is kept with two versions, the inactive one is freed or overwritten by the next commit
+ * */
+void* accessVersion(int numObj, int age){
+#if NUMVERSION > 2
+    int v = versionHead[numObj];
+
+    if(age >= NUMVERSION)
+        return NULL;
+    for(; age > 0; age--, v = OLDER(v))
+        if(validBeginRing[OLDER(v)][numObj] >= validBeginRing[v][numObj])
+            return NULL;
+    return mapRing[v][numObj];
+#else
+    return (age == 0)? accessData(numObj) : NULL;
+#endif
+}
+
+/*
+ * description: return the publish time of an older committed version
+ * parameters: number of the object, number of the versions committed after it (0 for the latest version)
+ * return: timeCounter when the version was published, only meaningful if accessVersion returns the version
+ * */
+unsigned long getCommitTime(int numObj, int age){
+#if NUMVERSION > 2
+    int v = versionHead[numObj];
+
+    for(; age > 0; age--)
+        v = OLDER(v);
+    return commitTimeRing[v][numObj];
+#else
+    int prefix = numObj/16, postfix = numObj%16;
+
+    ( void ) age;//only the latest version is kept
+    if(CHECK_BIT(mapSwitcher[prefix], postfix) > 0)
+        return commitTime1[numObj];
+    else
+        return commitTime0[numObj];
+#endif
+}
+
+/*
+ * description: overwrite the publish time of the latest version
+ * parameters: number of the object, publish time
+ * return: none
+ * note: used when a version is republished at another address with the same content
+ * */
+void setCommitTime(int numObj, unsigned long time){
+#if NUMVERSION > 2
+    commitTimeRing[versionHead[numObj]][numObj] = time;
+#else
+    int prefix = numObj/16, postfix = numObj%16;
+    if(CHECK_BIT(mapSwitcher[prefix], postfix) > 0)
+        commitTime1[numObj] = time;
+    else
+        commitTime0[numObj] = time;
+#endif
+}
+
+/*
+ * description: link the preallocated versions of a new object, used before the first commit of the object
+ * parameters: number of the object, address of NUMVERSION consecutive versions, size of each version
+ * return: none
+ * */
+void initShadow(int numObj, void* base, unsigned int size){
+#if NUMVERSION > 2
+    int v;
+
+    for(v = 0; v < NUMVERSION; v++){
+        mapRing[v][numObj] = (uint8_t*)base + v * size;
+        validBeginRing[v][numObj] = NEVERVALID;
+    }
+#else
+    map0[numObj] = base;
+    map1[numObj] = (uint8_t*)base + size;
+#endif
+}
+
+/*
+ * description: return the address of the allocation holding all the preallocated versions of an object
+ * parameters: number of the object
+ * return: the address given to initShadow
+ * */
+void* accessBase(int numObj){
+#if NUMVERSION > 2
+    return mapRing[0][numObj];
+#else
+    return map0[numObj];
+#endif
+}
+
+/*
+ * description: reset the maps of a deleted object as init does, the object is uncreated again
+ * parameters: number of the object
+ * return: none
+ * note: the versions are not freed, the caller hides the object first so that it is not read during the reset
+ * */
+void clearMaps(int numObj){
+#if NUMVERSION > 2
+    int v;
+
+    versionHead[numObj] = 0;
+    for(v = 0; v < NUMVERSION; v++){
+        mapRing[v][numObj] = NULL;
+        validBeginRing[v][numObj] = NEVERVALID;
+        validEndRing[v][numObj] = 0;
+        commitTimeRing[v][numObj] = 0;
+    }
+#else
+    mapSwitcher[numObj/16] &= ~(1 << (numObj%16));
+    map0[numObj] = NULL;
+    validBegin0[numObj] = 0;
+    validEnd0[numObj] = 0;
+    commitTime0[numObj] = 0;
+    map1[numObj] = NULL;
+    validBegin1[numObj] = 0;
+    validEnd1[numObj] = 0;
+    commitTime1[numObj] = 0;
+#endif
 }
 
 /*
@@ -177,21 +426,148 @@ void* accessData(int numObj){
  * return: none
  * */
 void commit(int numObj, void* commitaddress, unsigned long vBegin, unsigned long vEnd){
+#if NUMVERSION > 2
+    int v = OLDEST(numObj);
+
+    mapRing[v][numObj] = commitaddress;
+    validBeginRing[v][numObj] = vBegin;
+    validEndRing[v][numObj] = vEnd;
+    commitTimeRing[v][numObj] = timeCounter;
+
+    //atomic commit
+    versionHead[numObj] = v;
+#else
     int prefix = numObj/16,postfix = numObj%16;
     if(CHECK_BIT(mapSwitcher[prefix], postfix) > 0){
         map0[numObj] = commitaddress;
         validBegin0[numObj] = vBegin;
         validEnd0[numObj] = vEnd;
+        commitTime0[numObj] = timeCounter;
     }
     else{
         map1[numObj] = commitaddress;
         validBegin1[numObj] = vBegin;
         validEnd1[numObj] = vEnd;
+        commitTime1[numObj] = timeCounter;
     }
 
     //atomic commit
     mapSwitcher[prefix] ^= 1 << (postfix);
     //TODO: we need to use some trick to the stack pointer to use pushm for multiple section
+#endif
+}
+
+/*
+ * description: commit the addresses for a group of data objects with a single atomic switch
+ * parameters: number of the objects(max for MAXCOMMIT), ids of the objects, source addresses, validity interval
+ * return: none
+ * note: every object is written to its inactive map first, then the new mapSwitcher words are published together,
+ *       so a power failure either keeps all the previous versions or publishes all the new ones. Each id should appear once.
+ * */
+void commitGroup(int num, int* numObj, void** commitaddress, unsigned long vBegin, unsigned long vEnd){
+    unsigned long begin[MAXCOMMIT], end[MAXCOMMIT];
+    int i;
+
+    for(i = 0; i < num; i++){
+        begin[i] = vBegin;
+        end[i] = vEnd;
+    }
+    commitBatch(num, numObj, commitaddress, begin, end);
+}
+
+/*
+ * description: commit the addresses for a batch of data objects with their own validity intervals by a single atomic switch
+ * parameters: number of the objects(max for MAXGROUP), ids of the objects, source addresses, validity intervals
+ * return: none
+ * note: used by group commits of several tasks, each id should appear once
+ * */
+void commitBatch(int num, int* numObj, void** commitaddress, unsigned long* vBegin, unsigned long* vEnd){
+    int i, w, words = 0;
+    //new values of the touched switcher words, static as MAXGROUP is NUMOBJ with GROUPCOMMIT and this runs in interrupts.
+    //commitBatch is called in critical sections or interrupts, so it is never entered twice
+    static int word[MAXGROUP], value[MAXGROUP];
+#if NUMVERSION > 2
+    int v;
+
+    //each object is written to the oldest version of its ring and published by its versionHead
+    for(i = 0; i < num; i++){
+        v = OLDEST(numObj[i]);
+        mapRing[v][numObj[i]] = commitaddress[i];
+        validBeginRing[v][numObj[i]] = vBegin[i];
+        validEndRing[v][numObj[i]] = vEnd[i];
+        commitTimeRing[v][numObj[i]] = timeCounter;
+        word[words] = numObj[i];
+        value[words] = v;
+        words++;
+    }
+    if(words == 1){
+        versionHead[word[0]] = value[0];
+        return;
+    }
+#else
+    int prefix, postfix;
+
+    for(i = 0; i < num; i++){
+        prefix = numObj[i]/16;
+        postfix = numObj[i]%16;
+        for(w = 0; w < words; w++)
+            if(word[w] == prefix)
+                break;
+        if(w == words){
+            word[w] = prefix;
+            value[w] = mapSwitcher[prefix];
+            words++;
+        }
+
+        if(CHECK_BIT(value[w], postfix) > 0){
+            map0[numObj[i]] = commitaddress[i];
+            validBegin0[numObj[i]] = vBegin[i];
+            validEnd0[numObj[i]] = vEnd[i];
+            commitTime0[numObj[i]] = timeCounter;
+        }
+        else{
+            map1[numObj[i]] = commitaddress[i];
+            validBegin1[numObj[i]] = vBegin[i];
+            validEnd1[numObj[i]] = vEnd[i];
+            commitTime1[numObj[i]] = timeCounter;
+        }
+        value[w] ^= 1 << (postfix);
+    }
+
+    //atomic commit: objects sharing one switcher word are published by one word write
+    if(words == 1){
+        mapSwitcher[word[0]] = value[0];
+        return;
+    }
+#endif
+
+    //otherwise, log the new words and publish them by setting the record valid
+    for(w = 0; w < words; w++){
+        switchLog.word[w] = word[w];
+        switchLog.value[w] = value[w];
+    }
+    switchLog.num = words;
+    switchLog.valid = 1;
+    recoverMaps();
+}
+
+/*
+ * description: apply the valid redo record of mapSwitcher, called after each group commit and after power failures
+ * parameters: none
+ * return: none
+ * */
+void recoverMaps(){
+    int w;
+
+    if(switchLog.valid != 1)
+        return;
+    for(w = 0; w < switchLog.num; w++)
+#if NUMVERSION > 2
+        versionHead[switchLog.word[w]] = switchLog.value[w];
+#else
+        mapSwitcher[switchLog.word[w]] = switchLog.value[w];
+#endif
+    switchLog.valid = 0;
 }
 
 
@@ -201,6 +577,9 @@ void commit(int numObj, void* commitaddress, unsigned long vBegin, unsigned long
  * return: value of the begin interval
  * */
 unsigned long getBegin(int numObj){
+#if NUMVERSION > 2
+    return validBeginRing[versionHead[numObj]][numObj];
+#else
     int prefix = numObj/16, postfix = numObj%16;
     if(CHECK_BIT(mapSwitcher[prefix], postfix) > 0){
         dummy = 1;
@@ -210,6 +589,7 @@ unsigned long getBegin(int numObj){
         dummy = 0;
         return validBegin0[numObj];
     }
+#endif
 }
 
 
@@ -219,6 +599,9 @@ unsigned long getBegin(int numObj){
  * return: value of the End interval
  * */
 unsigned long getEnd(int numObj){
+#if NUMVERSION > 2
+    return validEndRing[versionHead[numObj]][numObj];
+#else
     int prefix = numObj/16,postfix = numObj%16;
     if(CHECK_BIT(mapSwitcher[prefix], postfix) > 0){
         dummy = 1;
@@ -228,6 +611,30 @@ unsigned long getEnd(int numObj){
         dummy = 0;
         return validEnd0[numObj];
     }
+#endif
+}
+
+/*
+ * description: overwrite the validity interval of the latest version
+ * parameters: number of the object, begin and end of the interval
+ * return: none
+ * note: used when the latest version is updated in place, the interval is not published atomically with the data
+ * */
+void setValidity(int numObj, unsigned long vBegin, unsigned long vEnd){
+#if NUMVERSION > 2
+    validBeginRing[versionHead[numObj]][numObj] = vBegin;
+    validEndRing[versionHead[numObj]][numObj] = vEnd;
+#else
+    int prefix = numObj/16, postfix = numObj%16;
+    if(CHECK_BIT(mapSwitcher[prefix], postfix) > 0){
+        validBegin1[numObj] = vBegin;
+        validEnd1[numObj] = vEnd;
+    }
+    else{
+        validBegin0[numObj] = vBegin;
+        validEnd0[numObj] = vEnd;
+    }
+#endif
 }
 
 
@@ -242,13 +649,19 @@ void dumpAll(){
     for(i = 0; i < NUMOBJ; i++){
         printf("%d: %p\n", i, accessData(i));
     }
+#if NUMVERSION > 2
+    printf("versionHead\n");
+    for(i = 0; i < NUMOBJ; i++)
+        printf("%d", versionHead[i]);
+#else
     printf("mapSwitcher\n");
     for(i = 0; i < NUMOBJ; i++){
-        int prefix = i/8, postfix = i%8;
+        int prefix = i/16, postfix = i%16;
         if(CHECK_BIT(mapSwitcher[prefix], postfix) > 0)
             printf("1");
         else
             printf("0");
     }
+#endif
     printf("\n");
 }
@@ -8,48 +8,45 @@
  *              ** call init() to reset data
  */
 
-#define NUMOBJ 16
-#define NUMCOMMIT 15
-#define CHECK_BIT(var,pos) ((var) & (1<<(pos)))
-
-#pragma DATA_SECTION(mapSwitcher, ".map") //each bit indicates address map for a object
-static int mapSwitcher[1];//16bit * 1 = 16 maximum objects
+#ifndef DATAMANAGER_MAPS_H_
+#define DATAMANAGER_MAPS_H_
 
+#include <config.h>
 
-/* Protected data for atomicity */
-#pragma NOINIT(map0)
-static void* map0[NUMOBJ];
-#pragma NOINIT(validBegin0)
-static unsigned long validBegin0[NUMOBJ];
-#pragma NOINIT(validEnd0)
-static unsigned long validEnd0[NUMOBJ];
+#define NUMCOMMIT 15
+#define SWITCHERWORDS ((NUMOBJ+15)/16) //16bit per word, one bit for each object
+#define CHECK_BIT(var,pos) ((var) & (1<<(pos)))
+#ifdef GROUPCOMMIT
+#define MAXGROUP NUMOBJ //a batch of group commits touches each object at most once
+#else
+#define MAXGROUP MAXCOMMIT
+#endif
 
-#pragma NOINIT(map1)
-static void* map1[NUMOBJ];
-#pragma NOINIT(validBegin1)
-static unsigned long validBegin1[NUMOBJ];
-#pragma NOINIT(validEnd1)
-static unsigned long validEnd1[NUMOBJ];
-
-/* internal functions */
-static unsigned long max(unsigned long a, unsigned long b){
-    if (a > b)
-        return a;
-    else
-        return b;
-}
+/* The protected data (map0/map1, validBegin0/1, validEnd0/1 and mapSwitcher) are defined in maps.c and sized by NUMOBJ,
+ * with NUMVERSION > 2 they are replaced by a ring of versions for each object and the index of its latest version (versionHead) */
 
 /* map functions */
 void init();
 void* access(int numObj);
 void accessCache(int numObj);
 void* accessData(int numObj);
+void* accessShadow(int numObj);
+void* accessVersion(int numObj, int age);
+void* accessBase(int numObj);
+void initShadow(int numObj, void* base, unsigned int size);
+void clearMaps(int numObj);
 void commit(int numObj, void* commitaddress, unsigned long vBegin, unsigned long vEnd);
+void commitGroup(int num, int* numObj, void** commitaddress, unsigned long vBegin, unsigned long vEnd);
+void commitBatch(int num, int* numObj, void** commitaddress, unsigned long* vBegin, unsigned long* vEnd);
 void dumpAll();
+void recoverMaps();
 unsigned long getBegin(int numObj);
 unsigned long getEnd(int numObj);
+unsigned long getCommitTime(int numObj, int age);
+void setCommitTime(int numObj, unsigned long time);
+void setValidity(int numObj, unsigned long vBegin, unsigned long vEnd);
 
+/* internal functions */
+unsigned long max(unsigned long a, unsigned long b);
 
-
-
-
+#endif /* DATAMANAGER_MAPS_H_ */
@@ -0,0 +1,153 @@
+/*
+ * slab.c
+ *
+ * Description: Functions to allocate and free the versions of data objects
+ */
+
+#include <DataManager/slab.h>
+#include <DataManager/SimpDB.h>
+#include <FreeRTOS.h>
+#include <task.h>
+
+#ifdef DBSLAB
+#pragma NOINIT(slabSpace) //blocks of all classes, each one starts with a word of its class
+static uint8_t slabSpace[SLABSIZE];
+
+#pragma DATA_SECTION(slabHead, ".map") //offset of the first free block of each class
+static unsigned int slabHead[SLABCLASSES];
+
+#pragma DATA_SECTION(slabBump, ".map") //offset of the region never carved
+static unsigned int slabBump;
+
+#define SLABHEADER sizeof(unsigned int)
+#define BLOCK(off) ((void*)&slabSpace[(off) + SLABHEADER])
+#define OFFSET(block) ((unsigned int)((uint8_t*)(block) - slabSpace) - SLABHEADER)
+#define CLASSOF(off) (*(unsigned int*)&slabSpace[off])
+#define NEXTOF(off) (*(unsigned int*)&slabSpace[(off) + SLABHEADER])//free blocks link the next one in their payload
+
+/* internal functions */
+static int prvClass(unsigned int size){
+    int c;
+
+    for(c = 0; c < SLABCLASSES; c++)
+        if(size <= (SLABMIN << c))
+            return c;
+    return -1;
+}
+
+static int prvOwns(void* block){
+    return (uint8_t*)block >= slabSpace && (uint8_t*)block < slabSpace + SLABSIZE;
+}
+#endif
+
+/*
+ * description: reset all the free lists
+ * parameters: none
+ * return: none
+ * note: should be called once with constructor()
+ * */
+void initSlab(){
+#ifdef DBSLAB
+    int c;
+
+    for(c = 0; c < SLABCLASSES; c++)
+        slabHead[c] = SLABNULL;
+    slabBump = 0;
+#endif
+}
+
+/*
+ * description: allocate a version and write it to the record
+ * parameters: size in bytes, record of the allocation
+ * return: none, *record is NULL for failure
+ * note: the record is written before the block leaves its free list, both in one critical section
+ * */
+void DBalloc(unsigned int size, void** record){
+#ifdef DBSLAB
+    int c = prvClass(size);
+    unsigned int off;
+
+    if(c >= 0){
+        DBENTER_CRITICAL();
+        off = slabHead[c];
+        if(off != SLABNULL){//reuse a free block
+            *record = BLOCK(off);
+            slabHead[c] = NEXTOF(off);
+            DBEXIT_CRITICAL();
+            return;
+        }
+        if(slabBump + SLABHEADER + (SLABMIN << c) <= SLABSIZE){//carve a new block
+            off = slabBump;
+            CLASSOF(off) = c;
+            *record = BLOCK(off);
+            slabBump = off + SLABHEADER + (SLABMIN << c);
+            DBEXIT_CRITICAL();
+            return;
+        }
+        DBEXIT_CRITICAL();
+    }
+#endif
+    *record = pvPortMalloc(size);
+}
+
+/*
+ * description: free the version in the record and clear the record
+ * parameters: record of the allocation
+ * return: none
+ * note: the block is returned by a single word write before the record is cleared, both in one critical section.
+ *       A block of the heap cannot be told freed after a power failure, so its record is cleared first, and a cut free leaks the block instead of freeing it twice
+ * */
+void DBfree(void** record){
+    void* block = *record;
+
+    if(block == NULL)
+        return;
+#ifdef DBSLAB
+    if(prvOwns(block)){
+        unsigned int off = OFFSET(block);
+
+        DBENTER_CRITICAL();
+        NEXTOF(off) = slabHead[CLASSOF(off)];
+        slabHead[CLASSOF(off)] = off;
+        *record = NULL;
+        DBEXIT_CRITICAL();
+        return;
+    }
+#endif
+    *record = NULL;
+    vPortFree(block);
+}
+
+/*
+ * description: check if a block is allocated from the size classes
+ * parameters: the block
+ * return: 1 for a block of the size classes, 0 for a block of the heap
+ * */
+int DBslab(void* block){
+#ifdef DBSLAB
+    return block != NULL && prvOwns(block);
+#else
+    ( void ) block;
+    return 0;
+#endif
+}
+
+/*
+ * description: check if a recorded block is in the allocator, used after power failures
+ * parameters: the block
+ * return: 1 if the block has not been taken or has been returned, 0 otherwise
+ * note: only valid for a block whose record is still written, blocks from the heap are always reported as taken
+ * */
+int DBfreed(void* block){
+#ifdef DBSLAB
+    unsigned int off;
+
+    if(block == NULL || !prvOwns(block))
+        return 0;
+    off = OFFSET(block);
+    return off >= slabBump || slabHead[CLASSOF(off)] == off;
+#else
+    ( void ) block;
+    return 0;
+#endif
+}
@@ -0,0 +1,32 @@
+/*
+ * slab.h
+ *
+ *  Description: Size-class allocator for the versions of data objects
+ *              ** Blocks are carved from a dedicated FRAM region, so committed data do not interleave with kernel objects in the heap
+ *              ** Each size class keeps a free list in FRAM, a block is taken or returned by a single word write of the list head
+ *              ** The caller passes a record (in FRAM) which is written before the block is taken and cleared after it is returned,
+ *                 so DBfreed() tells whether a recorded block is in the allocator after a power failure without scanning
+ *              ** Data larger than the largest class, or allocated when the region is full, come from the FreeRTOS heap
+ */
+
+#ifndef DATAMANAGER_SLAB_H_
+#define DATAMANAGER_SLAB_H_
+
+#include <config.h>
+
+#if defined(DBSLAB) && defined(SHADOWSLOT)
+#error "DBSLAB allocates the versions of each DBcommit, which are preallocated with SHADOWSLOT"
+#endif
+
+#define SLABMIN 8u //payload of the smallest class in bytes, each class doubles the previous one
+#define SLABCLASSES 6 //8, 16, 32, 64, 128 and 256 bytes
+#define SLABNULL 0xFFFF //end of a free list
+
+/* Functions to allocate versions */
+void initSlab();
+void DBalloc(unsigned int size, void** record);
+void DBfree(void** record);
+int DBfreed(void* block);
+int DBslab(void* block);
+
+#endif /* DATAMANAGER_SLAB_H_ */
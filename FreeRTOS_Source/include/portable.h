@@ -176,6 +176,7 @@ size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
 /* Considering recovery, this function can be used to be call for initializing variables at the first time */
 void pvInitHeapVar() PRIVILEGED_FUNCTION;
+size_t xPortGetLargestFreeBlock( void ) PRIVILEGED_FUNCTION;
 
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
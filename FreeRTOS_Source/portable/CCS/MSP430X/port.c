@@ -325,6 +325,13 @@ extern void vPortTickISR( void );
 	__bic_SR_register_on_exit( SCG1 + SCG0 + OSCOFF + CPUOFF );
     timeCounter++;//keep track of running time
 
+    #ifdef GROUPCOMMIT
+        //publish the commits staged during the last window
+        extern void DBpublish( void );
+        if(timeCounter % COALESCEWINDOW == 0)
+            DBpublish();
+    #endif
+
     //running time when the capacitor is at a low/high voltage
     if(voltage == 0)
         runLow++;
@@ -337,6 +344,11 @@ extern void vPortTickISR( void );
 		extern void vPortPreemptiveTickISR( void );
 		vPortPreemptiveTickISR();
 		tIn = pxCurrentTCB->taskID;
+		#ifdef DBEARLYABORT
+		    //mark the switched-in task if it cannot commit anymore
+		    extern void DBtickValidate( void );
+		    DBtickValidate();
+		#endif
 		//t1 is switched out
 		setStop(tOut);
 		//suspend lengthy tasks if needed
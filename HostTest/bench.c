@@ -0,0 +1,90 @@
+/*
+ * bench.c
+ *
+ *  Descriptions: Host benchmark of the latency of DBread and DBcommit with NUMOBJ objects, built for 16, 128 and 512
+ *  objects by the Makefile. The times are of the host, only their ratios across the builds are meaningful.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <HostTest/hostos.h>
+#include <DataManager/SimpDB.h>
+
+#define IDBENCH 4
+#define OBJSIZE 8
+#define ROUNDS 200000
+
+static double readNs, commitNs;
+static int benchFailed;
+
+/*
+ * description: current time of the host
+ * parameters: none
+ * return: time in ns
+ * */
+static double prvNow(){
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * description: the task creating NUMOBJ objects, then reading and committing them in turn
+ * parameters: none
+ * return: none
+ * */
+static void prvBenchTask(){
+    struct working w;
+    double start, spent;
+    volatile uint8_t sink = 0;
+    uint8_t* data;
+    long i;
+    int id;
+
+    for(id = 0; id < NUMOBJ; id++){
+        registerTCB(IDBENCH);
+        hostTick();
+        DBworkingSize(&w, -1, OBJSIZE, LOCVM);
+        memset(w.address, id, OBJSIZE);
+        if(DBcommit(&w, OBJSIZE, 1) != id)
+            benchFailed = 1;
+    }
+
+    registerTCB(IDBENCH);
+    start = prvNow();
+    for(i = 0; i < ROUNDS; i++){
+        data = DBread(i % NUMOBJ);
+        sink += data[0];
+    }
+    readNs = (prvNow() - start) / ROUNDS;
+
+    //a commit of each object needs a new registration and tick, which are not timed
+    spent = 0;
+    for(i = 0; i < ROUNDS; i++){
+        id = i % NUMOBJ;
+        registerTCB(IDBENCH);
+        hostTick();
+        DBworkingSize(&w, id, OBJSIZE, LOCVM);
+        memset(w.address, (int)i, OBJSIZE);
+        start = prvNow();
+        if(DBcommit(&w, 0, 1) != id)
+            benchFailed = 1;
+        spent += prvNow() - start;
+    }
+    commitNs = spent / ROUNDS;
+    unresgisterTCB(IDBENCH);
+}
+
+int main(){
+    struct hostTask t;
+
+    hostInit();
+    hostCreate(&t, prvBenchTask, IDBENCH, INVM);
+    if(hostRun(&t) != HOSTDONE || benchFailed){
+        printf("%d objects: FAILED\n", NUMOBJ);
+        return 1;
+    }
+    printf("%d objects: DBread %.1f ns, DBcommit %.1f ns\n", NUMOBJ, readNs, commitNs);
+    return 0;
+}
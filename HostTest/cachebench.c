@@ -0,0 +1,132 @@
+/*
+ * cachebench.c
+ *
+ *  Descriptions: Host benchmark of DBread under a skewed access pattern, built with and without DBCACHE by the Makefile.
+ *  Most reads and commits go to a few hot objects. The reads served from FRAM and the bytes written to FRAM are counted
+ *  by DBPROFILE, the times are of the host and only their ratio across the builds is meaningful.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <HostTest/hostos.h>
+#include <DataManager/SimpDB.h>
+
+#define IDBENCH 4
+#define OBJSIZE 32
+#define HOTOBJ 2 //objects taking HOTSHARE percent of the accesses
+#define HOTSHARE 90
+#define READS 8 //reads of each round, followed by a commit
+#define ROUNDS 50000
+
+static double readNs;
+static unsigned long framReads;
+static int benchFailed;
+static unsigned long seed = 1;
+static uint8_t expected[NUMOBJ];//first byte of the last commit of each object
+
+/*
+ * description: current time of the host
+ * parameters: none
+ * return: time in ns
+ * */
+static double prvNow(){
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * description: pick an object, a hot one for HOTSHARE percent of the picks
+ * parameters: none
+ * return: id of the object
+ * */
+static int prvPick(){
+    seed = seed * 1103515245 + 12345;
+    if((seed >> 16) % 100 < HOTSHARE)
+        return (seed >> 8) % HOTOBJ;
+    return HOTOBJ + (seed >> 8) % (NUMOBJ - HOTOBJ);
+}
+
+/*
+ * description: the task creating the objects, then reading them and committing one of them in each round
+ * parameters: none
+ * return: none
+ * */
+static void prvBenchTask(){
+    struct working w;
+    double start, spent = 0;
+    volatile uint8_t sink = 0;
+    uint8_t* data;
+    const uint8_t* version;
+    long i;
+    int id, k;
+
+    for(id = 0; id < NUMOBJ; id++){
+        registerTCB(IDBENCH);
+        hostTick();
+        DBworkingSize(&w, -1, OBJSIZE, LOCVM);
+        memset(w.address, id, OBJSIZE);
+        expected[id] = (uint8_t)id;
+        if(DBcommit(&w, OBJSIZE, 1) != id)
+            benchFailed = 1;
+    }
+#ifdef DBCACHE
+    DBcacheMisses = 0;
+    DBcacheHits = 0;
+#endif
+    DBwriteBytes = 0;
+    DBflushCount = 0;
+
+    for(i = 0; i < ROUNDS; i++){
+        registerTCB(IDBENCH);
+        hostTick();
+        start = prvNow();
+        for(k = 0; k < READS; k++){
+            data = DBread(prvPick());
+            sink += data[0];
+        }
+        spent += prvNow() - start;
+        id = prvPick();
+        DBworkingSize(&w, id, OBJSIZE, LOCVM);
+        memset(w.address, (int)i, OBJSIZE);
+        expected[id] = (uint8_t)i;
+        if(DBcommit(&w, 0, 1) != id)
+            benchFailed = 1;
+    }
+#ifdef DBCACHE
+    DBcacheFlush();//the versions in FRAM are checked below
+#endif
+    for(id = 0; id < NUMOBJ; id++){
+        version = accessData(id);
+        for(k = 0; k < OBJSIZE; k++)
+            if(version[k] != expected[id])
+                benchFailed = 1;
+    }
+    readNs = spent / (ROUNDS * READS);
+#ifdef DBCACHE
+    framReads = DBcacheMisses;
+#else
+    framReads = (unsigned long)ROUNDS * READS;
+#endif
+    unresgisterTCB(IDBENCH);
+}
+
+int main(){
+    struct hostTask t;
+#ifdef DBCACHE
+    const char* name = "DBCACHE";
+#else
+    const char* name = "no cache";
+#endif
+
+    hostInit();
+    hostCreate(&t, prvBenchTask, IDBENCH, INVM);
+    if(hostRun(&t) != HOSTDONE || benchFailed){
+        printf("%s: FAILED\n", name);
+        return 1;
+    }
+    printf("%s, %d%% of the accesses to %d of %d objects: DBread %.1f ns, %.1f%% of the reads from FRAM, %lu bytes written to FRAM by %d commits, %lu write-backs\n",
+           name, HOTSHARE, HOTOBJ, NUMOBJ, readNs, 100.0 * framReads / ((double)ROUNDS * READS), DBwriteBytes, ROUNDS, DBflushCount);
+    return 0;
+}
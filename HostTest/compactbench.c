@@ -0,0 +1,121 @@
+/*
+ * compactbench.c
+ *
+ *  Descriptions: Host benchmark of the heap fragmentation, built with DBCOMPACT (compactbench) and without it
+ *  (nocompactbench) by the Makefile. The objects are committed with random sizes while kernel objects come and go
+ *  in the heap, and DBcompact is called between the commits as the idle hook would. The largest free block of
+ *  heap_4 is sampled over the run.
+ */
+
+#include <stdio.h>
+#include <HostTest/hostos.h>
+#include <DataManager/SimpDB.h>
+
+#define IDBENCH 4
+#define MAXSIZE 240 //largest version
+#define KERNELBLOCKS 8 //kernel objects alive at the same time
+#define KERNELEVERY 16 //commits between the changes of the kernel objects
+#define IDLEEVERY 4 //commits between the idle slices
+#define ROUNDS 100000
+#define SAMPLEEVERY 100 //commits between the samples of the largest free block
+
+static size_t minLargest = (size_t)-1;
+static double sumLargest;
+static unsigned long moved;
+static int benchFailed;
+static unsigned long seed = 1;
+
+/*
+ * description: a pseudo-random number, the same sequence for both builds
+ * parameters: bound
+ * return: a number below the bound
+ * */
+static unsigned int prvRandom(unsigned int bound){
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % bound;
+}
+
+/*
+ * description: the task committing the objects with random sizes, with kernel objects allocated and freed in between
+ * parameters: none
+ * return: none
+ * */
+static void prvBenchTask(){
+    struct working w;
+    void* kernel[KERNELBLOCKS] = {NULL};
+    unsigned int size;
+    size_t largest;
+    long i;
+    int id, k;
+
+    for(id = 0; id < NUMOBJ; id++){
+        registerTCB(IDBENCH);
+        hostTick();
+        DBworkingSize(&w, -1, MAXSIZE, LOCVM);
+        if(w.address == NULL || DBcommit(&w, MAXSIZE, 1) != id)
+            benchFailed = 1;
+    }
+
+    for(i = 0; i < ROUNDS && !benchFailed; i++){
+        id = prvRandom(NUMOBJ);
+        size = 8 + prvRandom(MAXSIZE - 8);
+
+        registerTCB(IDBENCH);
+        hostTick();
+        DBworkingSize(&w, id, size, LOCNVM);
+        if(w.address == NULL){
+            benchFailed = 1;
+            break;
+        }
+        memset(w.address, (int)i, size);
+        if(DBcommit(&w, size, 1) != id)
+            benchFailed = 1;
+        unresgisterTCB(IDBENCH);
+
+        if(i % KERNELEVERY == 0){//a task or a queue is created or deleted
+            k = prvRandom(KERNELBLOCKS);
+            if(kernel[k] != NULL){
+                vPortFree(kernel[k]);
+                kernel[k] = NULL;
+            }
+            else
+                kernel[k] = pvPortMalloc(40 + prvRandom(360));
+        }
+#ifdef DBCOMPACT
+        if(i % IDLEEVERY == 0)//no task is running
+            moved += DBcompact(COMPACTBYTES);
+#endif
+        if(i % SAMPLEEVERY == 0){
+            largest = xPortGetLargestFreeBlock();
+            sumLargest += largest;
+            if(largest < minLargest)
+                minLargest = largest;
+        }
+    }
+    for(k = 0; k < KERNELBLOCKS; k++)
+        vPortFree(kernel[k]);
+}
+
+int main(){
+    struct hostTask t;
+    size_t largest, freeBytes;
+#ifdef DBCOMPACT
+    const char* name = "DBCOMPACT";
+#else
+    const char* name = "no compaction";
+#endif
+
+    hostInit();
+    hostCreate(&t, prvBenchTask, IDBENCH, INVM);
+    if(hostRun(&t) != HOSTDONE || benchFailed){
+        printf("%s: FAILED\n", name);
+        return 1;
+    }
+    largest = xPortGetLargestFreeBlock();
+    freeBytes = xPortGetFreeHeapSize();
+    printf("%s, %d commits of 8 to %d bytes to %d objects: largest free block %lu on average, %lu at the smallest during the run, "
+           "%lu at the end of %lu free (%.1f%% fragmented), %lu bytes moved\n",
+           name, ROUNDS, MAXSIZE, NUMOBJ, (unsigned long)(sumLargest / (ROUNDS / SAMPLEEVERY)), (unsigned long)minLargest,
+           (unsigned long)largest, (unsigned long)freeBytes, 100.0 * (1.0 - (double)largest / freeBytes), moved);
+    return 0;
+}
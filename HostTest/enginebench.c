@@ -0,0 +1,111 @@
+/*
+ * enginebench.c
+ *
+ *  Descriptions: Host benchmark matrix of the commit engines, built with UNDOLOG (undobench) and with the switch of
+ *  the maps (switchbench) by the Makefile. For each object size and commit rate, an object is read READS times for
+ *  each commit, and the times of DBread and DBcommit and the bytes written to FRAM by DBPROFILE are reported.
+ *  The times are of the host, only their ratios across the builds are meaningful.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <HostTest/hostos.h>
+#include <DataManager/SimpDB.h>
+
+#define IDBENCH 4
+#define NUMSIZES 4
+#define NUMRATES 3
+#define COMMITS 20000
+
+static const int sizes[NUMSIZES] = {4, 16, 64, 256};
+static const int reads[NUMRATES] = {1, 8, 64};//reads for each commit
+static double readNs[NUMSIZES][NUMRATES], commitNs[NUMSIZES][NUMRATES];
+static unsigned long writeBytes[NUMSIZES][NUMRATES];
+static int benchFailed;
+
+/*
+ * description: current time of the host
+ * parameters: none
+ * return: time in ns
+ * */
+static double prvNow(){
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * description: the task creating an object of each size, then reading and committing it at each rate
+ * parameters: none
+ * return: none
+ * */
+static void prvBenchTask(){
+    struct working w;
+    double start, readSpent, commitSpent;
+    volatile uint8_t sink = 0;
+    const uint8_t* data;
+    long i;
+    int s, r, k, id;
+
+    for(s = 0; s < NUMSIZES; s++){
+        registerTCB(IDBENCH);
+        hostTick();
+        DBworkingSize(&w, -1, sizes[s], LOCNVM);
+        memset(w.address, 0, sizes[s]);
+        if(DBcommit(&w, sizes[s], 1) != s)
+            benchFailed = 1;
+    }
+
+    //the registration and the tick of each commit are not timed
+    for(s = 0; s < NUMSIZES; s++){
+        id = s;
+        for(r = 0; r < NUMRATES; r++){
+            readSpent = 0;
+            commitSpent = 0;
+            DBwriteBytes = 0;
+            for(i = 0; i < COMMITS; i++){
+                registerTCB(IDBENCH);
+                hostTick();
+                start = prvNow();
+                for(k = 0; k < reads[r]; k++){
+                    data = DBread(id);
+                    sink += data[k % sizes[s]];
+                }
+                readSpent += prvNow() - start;
+                DBworkingSize(&w, id, sizes[s], LOCNVM);
+                memset(w.address, (int)i, sizes[s]);
+                start = prvNow();
+                if(DBcommit(&w, 0, 1) != id)
+                    benchFailed = 1;
+                commitSpent += prvNow() - start;
+            }
+            readNs[s][r] = readSpent / ((double)COMMITS * reads[r]);
+            commitNs[s][r] = commitSpent / COMMITS;
+            writeBytes[s][r] = DBwriteBytes / COMMITS;
+        }
+    }
+    unresgisterTCB(IDBENCH);
+}
+
+int main(){
+    struct hostTask t;
+    int s, r;
+#ifdef UNDOLOG
+    const char* name = "UNDOLOG";
+#else
+    const char* name = "switch";
+#endif
+
+    hostInit();
+    hostCreate(&t, prvBenchTask, IDBENCH, INVM);
+    if(hostRun(&t) != HOSTDONE || benchFailed){
+        printf("%s: FAILED\n", name);
+        return 1;
+    }
+    for(s = 0; s < NUMSIZES; s++)
+        for(r = 0; r < NUMRATES; r++)
+            printf("%s, %d bytes, a commit every %d reads: DBread %.1f ns, DBcommit %.1f ns, %lu bytes written to FRAM by each commit\n",
+                   name, sizes[s], reads[r], readNs[s][r], commitNs[s][r], writeBytes[s][r]);
+    return 0;
+}
@@ -0,0 +1,354 @@
+/*
+ * hostos.c
+ *
+ *  Descriptions: Host stand-in of the kernel, the task manager and the drivers used by the data manager
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <HostTest/hostos.h>
+#include <DataManager/SimpDB.h>
+#include <DataManager/LogDB.h>
+#include <DataManager/slab.h>
+#include <Tools/dmacopy.h>
+#include <driverlib.h>
+
+#define HOSTSTACKSIZE (64 * 1024)
+
+
+/*
+ * Task control block.  A task control block (TCB) is allocated for each task,
+ * and stores task state information, including a pointer to the task's context
+ * (the task's run time environment, including register values)
+ */
+typedef struct tskTaskControlBlock
+{
+    volatile StackType_t    *pxTopOfStack;  /*< Points to the location of the last item placed on the tasks stack.  THIS MUST BE THE FIRST MEMBER OF THE TCB STRUCT. */
+
+    #if ( portUSING_MPU_WRAPPERS == 1 )
+        xMPU_SETTINGS   xMPUSettings;       /*< The MPU settings are defined as part of the port layer.  THIS MUST BE THE SECOND MEMBER OF THE TCB STRUCT. */
+    #endif
+
+    ListItem_t          xStateListItem; /*< The list that the state list item of a task is reference from denotes the state of that task (Ready, Blocked, Suspended ). */
+    ListItem_t          xEventListItem;     /*< Used to reference a task from an event list. */
+    UBaseType_t         uxPriority;         /*< The priority of the task.  0 is the lowest priority. */
+    StackType_t         *pxStack;           /*< Points to the start of the stack. */
+    char                pcTaskName[ configMAX_TASK_NAME_LEN ];/*< Descriptive name given to the task when created.  Facilitates debugging only. */ /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+
+    /*------------------------------  Extend to support validation: Start ------------------------------*/
+    unsigned long vBegin;
+    unsigned long vEnd;
+    /*------------------------------  Extend to support validation: End ------------------------------*/
+    /*------------------------------  Extend to support dynamic stack: Start ------------------------------*/
+    void * AddressOfVMStack;
+    void * AddressOffset;
+    int StackInNVM;
+    int taskID;
+    /*------------------------------  Extend to support dynamic stack: End ------------------------------*/
+    /*------------------------------  Extend to support dynamic function: Start ------------------------------*/
+    void * AddressOfNVMFunction;
+    void * AddressOfVMFunction;
+    void * CodeOffset;
+    int SizeOfFunction;
+    int CodeInNVM;
+    /*------------------------------  Extend to support dynamic function: End ------------------------------*/
+
+    #if ( portSTACK_GROWTH > 0 )
+        StackType_t     *pxEndOfStack;      /*< Points to the end of the stack on architectures where the stack grows up from low memory. */
+    #endif
+
+    #if ( portCRITICAL_NESTING_IN_TCB == 1 )
+        UBaseType_t     uxCriticalNesting;  /*< Holds the critical section nesting depth for ports that do not maintain their own count in the port layer. */
+    #endif
+
+    #if ( configUSE_TRACE_FACILITY == 1 )
+        UBaseType_t     uxTCBNumber;        /*< Stores a number that increments each time a TCB is created.  It allows debuggers to determine when a task has been deleted and then recreated. */
+        UBaseType_t     uxTaskNumber;       /*< Stores a number specifically for use by third party trace code. */
+    #endif
+
+    #if ( configUSE_MUTEXES == 1 )
+        UBaseType_t     uxBasePriority;     /*< The priority last assigned to the task - used by the priority inheritance mechanism. */
+        UBaseType_t     uxMutexesHeld;
+    #endif
+
+    #if ( configUSE_APPLICATION_TASK_TAG == 1 )
+        TaskHookFunction_t pxTaskTag;
+    #endif
+
+    #if( configNUM_THREAD_LOCAL_STORAGE_POINTERS > 0 )
+        void *pvThreadLocalStoragePointers[ configNUM_THREAD_LOCAL_STORAGE_POINTERS ];
+    #endif
+
+    #if( configGENERATE_RUN_TIME_STATS == 1 )
+        uint32_t        ulRunTimeCounter;   /*< Stores the amount of time the task has spent in the Running state. */
+    #endif
+
+    #if ( configUSE_NEWLIB_REENTRANT == 1 )
+        /* Allocate a Newlib reent structure that is specific to this task.
+        Note Newlib support has been included by popular demand, but is not
+        used by the FreeRTOS maintainers themselves.  FreeRTOS is not
+        responsible for resulting newlib operation.  User must be familiar with
+        newlib and must provide system-wide implementations of the necessary
+        stubs. Be warned that (at the time of writing) the current newlib design
+        implements a system-wide malloc() that must be provided with locks. */
+        struct  _reent xNewLib_reent;
+    #endif
+
+    #if( configUSE_TASK_NOTIFICATIONS == 1 )
+        volatile uint32_t ulNotifiedValue;
+        volatile uint8_t ucNotifyState;
+    #endif
+
+    /* See the comments above the definition of
+    tskSTATIC_AND_DYNAMIC_ALLOCATION_POSSIBLE. */
+    #if( tskSTATIC_AND_DYNAMIC_ALLOCATION_POSSIBLE != 0 )
+        uint8_t ucStaticallyAllocated;      /*< Set to pdTRUE if the task is a statically allocated to ensure no attempt is made to free the memory. */
+    #endif
+
+    #if( INCLUDE_xTaskAbortDelay == 1 )
+        uint8_t ucDelayAborted;
+    #endif
+
+} tskTCB;
+
+
+tskTCB * volatile pxCurrentTCB;
+unsigned long timeCounter;
+uint8_t ucHeap[configTOTAL_HEAP_SIZE];
+volatile unsigned int TB0R;
+void (*hostSramLoss)(void) = NULL;
+
+static tskTCB idleTCB;//current TCB out of the tasks, e.g. during the recovery
+static ucontext_t hostMain;
+static struct hostTask* hostCurrent;
+static int hostResult;
+static unsigned int hostTCBNumber;
+static int hostNesting;
+static long hostHeapBlocks;
+static unsigned long hostCopies, hostFailCopy;
+static unsigned char hostLocation[NUMTASK], hostStatus[NUMTASK];
+static uint32_t hostCRC;
+
+/*
+ * description: critical sections of the kernel, the tasks are switched only at their calls to the data manager
+ * parameters: none
+ * return: none
+ * */
+void vPortEnterCritical(void){
+    hostNesting++;
+}
+
+void vPortExitCritical(void){
+    if(--hostNesting < 0){
+        fprintf(stderr, "hostos: unbalanced critical section\n");
+        abort();
+    }
+}
+
+void vTaskSuspendAll(void){
+}
+
+BaseType_t xTaskResumeAll(void){
+    return pdFALSE;
+}
+
+/*
+ * description: a task waits for an object locked by another task, which never runs again on the host
+ * parameters: ticks
+ * return: none
+ * */
+void vTaskDelay(TickType_t xTicksToDelay){
+    ( void ) xTicksToDelay;
+    fprintf(stderr, "hostos: task %d waits forever\n", pxCurrentTCB->taskID);
+    abort();
+}
+
+/*
+ * description: the heap in FRAM is heap_4 of the device, its blocks are counted by the trace hooks to find the leaked versions
+ * parameters: the block
+ * return: none
+ * */
+void hostTraceMalloc(void* pv){
+    if(pv != NULL)
+        hostHeapBlocks++;
+}
+
+void hostTraceFree(void* pv){
+    ( void ) pv;
+    hostHeapBlocks--;
+}
+
+void vApplicationMallocFailedHook(void){
+    //the data manager handles a failed allocation, the device stops in its hook instead
+}
+
+long hostBlocks(){
+    return hostHeapBlocks;
+}
+
+/*
+ * description: the copy engine, the power fails before the copy chosen by hostFailAt
+ * parameters: destination, source, size in terms of bytes
+ * return: the destination
+ * */
+void initDMAcopy(){
+}
+
+void* DMAcopy(void* dst, const void* src, size_t size){
+    if(hostCurrent != NULL && hostFailCopy > 0 && ++hostCopies == hostFailCopy){
+        hostResult = HOSTFAILED;
+        hostFailCopy = 0;
+        swapcontext(&hostCurrent->context, &hostMain);//never resumed unless the task is lengthy
+    }
+    return memcpy(dst, src, size);
+}
+
+void hostFailAt(unsigned long copy){
+    hostCopies = 0;
+    hostFailCopy = copy;
+}
+
+/*
+ * description: the CRC32 module and the interrupt state of the MSP430
+ * */
+void CRC32_setSeed(uint32_t seed, uint8_t crcMode){
+    ( void ) crcMode;//only CRC32 is used by the data manager
+    hostCRC = seed;
+}
+
+void CRC32_set8BitData(uint8_t dataIn, uint8_t crcMode){
+    int bit;
+
+    ( void ) crcMode;
+    hostCRC ^= dataIn;
+    for(bit = 0; bit < 8; bit++)
+        hostCRC = (hostCRC >> 1) ^ (0xEDB88320 & (0 - (hostCRC & 1)));
+}
+
+void CRC32_set16BitData(uint16_t dataIn, uint8_t crcMode){
+    CRC32_set8BitData(dataIn & 0xFF, crcMode);
+    CRC32_set8BitData(dataIn >> 8, crcMode);
+}
+
+uint32_t CRC32_getResult(uint8_t crcMode){
+    ( void ) crcMode;
+    return hostCRC;
+}
+
+istate_t __get_interrupt_state(void){
+    return 0;
+}
+
+void __set_interrupt_state(istate_t state){
+    ( void ) state;
+}
+
+void __disable_interrupt(void){
+}
+
+/*
+ * description: the task manager and the recovery handler seen by the data manager
+ * */
+int getStatus(int taskID){
+    return hostStatus[taskID];
+}
+
+int getLocation(int taskID){
+    return hostLocation[taskID];
+}
+
+void markCommit(int taskID){
+    ( void ) taskID;
+}
+
+void regTaskEnd(){
+}
+
+void taskRerun(){
+    hostResult = HOSTRERUN;
+    hostCurrent->started = 0;
+    swapcontext(&hostCurrent->context, &hostMain);
+    fprintf(stderr, "hostos: a deleted task is resumed\n");
+    abort();
+}
+
+/*
+ * description: entry of the stack of a task
+ * parameters: none
+ * return: none
+ * */
+static void prvHostEntry(){
+    hostCurrent->code();
+    hostResult = HOSTDONE;
+    hostCurrent->started = 0;
+}
+
+void hostInit(){
+    timeCounter = 1;
+    idleTCB.taskID = IDIDLE;
+    pxCurrentTCB = &idleTCB;
+    pvInitHeapVar();
+    constructor();
+    initLogs();
+    initSlab();
+}
+
+void hostCreate(struct hostTask* t, void (*code)(void), int slot, int location){
+    t->code = code;
+    t->slot = slot;
+    t->location = location;
+    t->started = 0;
+    t->tcb = calloc(1, sizeof(tskTCB));
+    t->stack = malloc(HOSTSTACKSIZE);
+    hostLocation[slot] = location;
+    hostStatus[slot] = RUN;
+}
+
+int hostRun(struct hostTask* t){
+    tskTCB* tcb = t->tcb;
+
+    if(t->started == 0){//a new TCB for every run, as taskRerun creates the task again
+        memset(tcb, 0, sizeof(tskTCB));
+        tcb->taskID = t->slot;
+        tcb->StackInNVM = t->location;
+        tcb->uxTCBNumber = ++hostTCBNumber;
+        getcontext(&t->context);
+        t->context.uc_stack.ss_sp = t->stack;
+        t->context.uc_stack.ss_size = HOSTSTACKSIZE;
+        t->context.uc_link = &hostMain;
+        makecontext(&t->context, prvHostEntry, 0);
+        t->started = 1;
+    }
+    hostStatus[t->slot] = RUN;
+    hostCurrent = t;
+    pxCurrentTCB = tcb;
+    swapcontext(&hostMain, &t->context);
+    hostCurrent = NULL;
+    pxCurrentTCB = &idleTCB;
+    hostStatus[t->slot] = STOP;//switched out, its context is saved
+
+    return hostResult;
+}
+
+void hostReboot(struct hostTask* tasks, int num){
+    int i;
+
+    hostNesting = 0;
+    for(i = 0; i < num; i++)
+        if(tasks[i].location == INVM)
+            tasks[i].started = 0;//the stack in SRAM is lost, the task is rerun
+    if(hostSramLoss != NULL)
+        hostSramLoss();
+    DBrecovery();
+    recoverLogs();
+}
+
+void hostTick(){
+    timeCounter++;
+}
+
+void hostYield(){
+    hostResult = HOSTYIELD;
+    swapcontext(&hostCurrent->context, &hostMain);
+}
@@ -0,0 +1,51 @@
+/*
+ * hostos.h
+ *
+ *  Descriptions: Host stand-in of the kernel, the task manager and the drivers used by the data manager.
+ *  Each task runs on its own stack, so that a power failure injected at a copy of the data manager cuts the task
+ *  where it is: a lengthy task (INNVM) is resumed from there after recovery and the others are rerun from the start.
+ */
+
+#ifndef HOSTTEST_HOSTOS_H_
+#define HOSTTEST_HOSTOS_H_
+
+#include <ucontext.h>
+#include <TaskManager/taskManager.h>
+
+enum{
+    HOSTDONE = 0,//the task returned
+    HOSTRERUN,//the task called taskRerun, it is rerun from the start by the next hostRun
+    HOSTFAILED,//the power failed in the task
+    HOSTYIELD//the task called hostYield, it is resumed by the next hostRun
+};
+
+struct hostTask{
+    void (*code)(void);
+    int slot;//task slot, see config.h
+    int location;//INVM for a task rerun after power failures, INNVM for a lengthy task resumed after them
+    int started;//0 if the next hostRun starts the task from the beginning
+    void* tcb;
+    void* stack;
+    ucontext_t context;
+};
+
+/* set up the data manager as main() does for the first boot */
+void hostInit();
+/* prepare a task, it is started by hostRun */
+void hostCreate(struct hostTask* t, void (*code)(void), int slot, int location);
+/* run or resume the task until it returns, reruns or is cut by a power failure */
+int hostRun(struct hostTask* t);
+/* cut the power at the copy-th DMAcopy of the tasks from now on, 0 for never */
+void hostFailAt(unsigned long copy);
+/* boot again after a power failure: the SRAM state is lost and the data manager is recovered as main() does */
+void hostReboot(struct hostTask* tasks, int num);
+/* move to the next tick, commits of the same object need different ticks */
+void hostTick();
+/* switch out the running task, as a tick preempting it does */
+void hostYield();
+/* blocks allocated from the heap and not freed yet */
+long hostBlocks();
+/* called by hostReboot to clear the SRAM state of the data manager, NULL by default */
+extern void (*hostSramLoss)(void);
+
+#endif /* HOSTTEST_HOSTOS_H_ */
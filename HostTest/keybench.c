@@ -0,0 +1,127 @@
+/*
+ * keybench.c
+ *
+ *  Descriptions: Host benchmark of the key-addressed objects of KeyDB against the integer ids, built for 64 objects by
+ *  the Makefile. Half of the objects are created, read and written by their ids, the other half by their keys. The
+ *  times are of the host, only their ratios are meaningful.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <HostTest/hostos.h>
+#include <DataManager/SimpDB.h>
+#include <DataManager/KeyDB.h>
+
+#define IDBENCH 4
+#define OBJSIZE 8
+#define HALF (NUMOBJ / 2)
+#define ROUNDS 200000
+#define KEY(i) (1000003UL * ((i) + 1)) //keys spread over the hash index
+
+static double createNs[2], readNs[2], writeNs[2];//by id, by key
+static int benchFailed;
+static int ids[HALF];
+
+/*
+ * description: current time of the host
+ * parameters: none
+ * return: time in ns
+ * */
+static double prvNow(){
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * description: the task creating the objects, then reading and writing them in turn by ids and by keys
+ * parameters: none
+ * return: none
+ * */
+static void prvBenchTask(){
+    struct working w;
+    double start;
+    volatile uint8_t sink = 0;
+    uint8_t* data;
+    long i;
+    int k;
+
+    //the registration and the tick of each commit are not timed
+    for(k = 0; k < HALF; k++){
+        registerTCB(IDBENCH);
+        hostTick();
+        DBworkingSize(&w, -1, OBJSIZE, LOCVM);
+        memset(w.address, k, OBJSIZE);
+        start = prvNow();
+        ids[k] = DBcommit(&w, OBJSIZE, 1);
+        createNs[0] += prvNow() - start;
+        if(ids[k] < 0)
+            benchFailed = 1;
+    }
+    for(k = 0; k < HALF; k++){
+        registerTCB(IDBENCH);
+        hostTick();
+        DBworkingSize(&w, -1, OBJSIZE, LOCVM);
+        memset(w.address, k, OBJSIZE);
+        start = prvNow();
+        if(DBput(KEY(k), &w, OBJSIZE) < 0)
+            benchFailed = 1;
+        createNs[1] += prvNow() - start;
+    }
+    createNs[0] /= HALF;
+    createNs[1] /= HALF;
+
+    registerTCB(IDBENCH);
+    start = prvNow();
+    for(i = 0; i < ROUNDS; i++){
+        data = DBread(ids[i % HALF]);
+        sink += data[0];
+    }
+    readNs[0] = (prvNow() - start) / ROUNDS;
+    start = prvNow();
+    for(i = 0; i < ROUNDS; i++){
+        data = DBget(KEY(i % HALF));
+        sink += data[0];
+    }
+    readNs[1] = (prvNow() - start) / ROUNDS;
+
+    for(i = 0; i < ROUNDS; i++){
+        registerTCB(IDBENCH);
+        hostTick();
+        DBworkingSize(&w, ids[i % HALF], OBJSIZE, LOCVM);
+        memset(w.address, (int)i, OBJSIZE);
+        start = prvNow();
+        if(DBcommit(&w, OBJSIZE, 1) < 0)
+            benchFailed = 1;
+        writeNs[0] += prvNow() - start;
+    }
+    for(i = 0; i < ROUNDS; i++){
+        registerTCB(IDBENCH);
+        hostTick();
+        DBworkingSize(&w, -1, OBJSIZE, LOCVM);
+        memset(w.address, (int)i, OBJSIZE);
+        start = prvNow();
+        if(DBput(KEY(i % HALF), &w, OBJSIZE) < 0)
+            benchFailed = 1;
+        writeNs[1] += prvNow() - start;
+    }
+    writeNs[0] /= ROUNDS;
+    writeNs[1] /= ROUNDS;
+    unresgisterTCB(IDBENCH);
+}
+
+int main(){
+    struct hostTask t;
+
+    hostInit();
+    initKeys();
+    hostCreate(&t, prvBenchTask, IDBENCH, INVM);
+    if(hostRun(&t) != HOSTDONE || benchFailed){
+        printf("FAILED\n");
+        return 1;
+    }
+    printf("%d objects by ids: create %.1f ns, DBread %.1f ns, DBcommit %.1f ns\n", HALF, createNs[0], readNs[0], writeNs[0]);
+    printf("%d objects by keys: DBput of a new key %.1f ns, DBget %.1f ns, DBput %.1f ns\n", HALF, createNs[1], readNs[1], writeNs[1]);
+    return 0;
+}
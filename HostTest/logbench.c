@@ -0,0 +1,94 @@
+/*
+ * logbench.c
+ *
+ *  Descriptions: Host benchmark of the samples stored per second by DBappend to a log, against committing the whole
+ *  buffer of LOGSIZE bytes by DBcommit for every sample. The times are of the host, only the ratio is meaningful.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <HostTest/hostos.h>
+#include <DataManager/SimpDB.h>
+#include <DataManager/LogDB.h>
+
+#define IDBENCH 4
+#define SAMPLESIZE 4
+#define SAMPLES 200000
+
+static double appendRate, commitRate;
+static int benchFailed;
+
+/*
+ * description: current time of the host
+ * parameters: none
+ * return: time in s
+ * */
+static double prvNow(){
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/*
+ * description: the task storing the samples both ways
+ * parameters: none
+ * return: none
+ * */
+static void prvBenchTask(){
+    struct working w;
+    double start;
+    unsigned long sample;
+    long n;
+    int id;
+
+    //appends, the log is cleared when it is full and every fill is a run of the task
+    start = prvNow();
+    registerTCB(IDBENCH);
+    for(n = 0, sample = 0; n < SAMPLES; sample++){
+        if(DBappend(0, &sample, SAMPLESIZE) == 0){
+            n++;
+            continue;
+        }
+        DBlogClear(0);
+        registerTCB(IDBENCH);
+    }
+    appendRate = SAMPLES / (prvNow() - start);
+
+    //the buffer is read, updated by the sample and committed as a new version
+    registerTCB(IDBENCH);
+    hostTick();
+    DBworkingSize(&w, -1, LOGSIZE, LOCNVM);
+    memset(w.address, 0, LOGSIZE);
+    id = DBcommit(&w, LOGSIZE, 1);
+    if(id < 0){
+        benchFailed = 1;
+        return;
+    }
+    start = prvNow();
+    for(n = 0, sample = 0; n < SAMPLES; n++, sample++){
+        registerTCB(IDBENCH);
+        hostTick();
+        DBworkingSize(&w, id, LOGSIZE, LOCNVM);
+        DBreadIn(w.address, id);
+        memcpy((uint8_t*)w.address + (n * SAMPLESIZE) % LOGSIZE, &sample, SAMPLESIZE);
+        if(DBcommit(&w, 0, 1) != id)
+            benchFailed = 1;
+    }
+    commitRate = SAMPLES / (prvNow() - start);
+    unresgisterTCB(IDBENCH);
+}
+
+int main(){
+    struct hostTask t;
+
+    hostInit();
+    hostCreate(&t, prvBenchTask, IDBENCH, INVM);
+    if(hostRun(&t) != HOSTDONE || benchFailed){
+        printf("log: FAILED\n");
+        return 1;
+    }
+    printf("%d-byte samples: DBappend %.0f per second, DBcommit of a %d-byte buffer %.0f per second, %.1fx\n",
+           SAMPLESIZE, appendRate, LOGSIZE, commitRate, appendRate / commitRate);
+    return 0;
+}
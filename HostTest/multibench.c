@@ -0,0 +1,105 @@
+/*
+ * multibench.c
+ *
+ *  Descriptions: Host benchmark of the atomic commit of several objects, built with DBPROFILE by the Makefile.
+ *  Each round updates N objects either by one DBcommit of N working spaces or by N single DBcommit, and the time and
+ *  the critical sections of each object are reported. The times are of the host, only their ratio is meaningful.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <HostTest/hostos.h>
+#include <DataManager/SimpDB.h>
+
+#define IDBENCH 4
+#define OBJSIZE 8
+#define ROUNDS 200000
+
+static double groupNs[MAXCOMMIT + 1], singleNs[MAXCOMMIT + 1];
+static double groupCritical[MAXCOMMIT + 1], singleCritical[MAXCOMMIT + 1];
+static int benchFailed;
+
+/*
+ * description: current time of the host
+ * parameters: none
+ * return: time in ns
+ * */
+static double prvNow(){
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * description: the task creating the objects, then updating N of them in each round, for N of 1 to MAXCOMMIT
+ * parameters: none
+ * return: none
+ * */
+static void prvBenchTask(){
+    struct working w[MAXCOMMIT];
+    double start;
+    long i;
+    int n, k, id;
+
+    for(id = 0; id < MAXCOMMIT; id++){
+        registerTCB(IDBENCH);
+        hostTick();
+        DBworkingSize(&w[0], -1, OBJSIZE, LOCVM);
+        memset(w[0].address, id, OBJSIZE);
+        if(DBcommit(w, OBJSIZE, 1) != id)
+            benchFailed = 1;
+    }
+
+    //the registration and the tick of each round are not timed, the working spaces are
+    for(n = 1; n <= MAXCOMMIT; n++){
+        DBcriticalCount = 0;
+        for(i = 0; i < ROUNDS; i++){
+            registerTCB(IDBENCH);
+            hostTick();
+            start = prvNow();
+            for(k = 0; k < n; k++){
+                DBworkingSize(&w[k], k, OBJSIZE, LOCVM);
+                memset(w[k].address, (int)i, OBJSIZE);
+            }
+            if(DBcommit(w, OBJSIZE, n) != 0)
+                benchFailed = 1;
+            groupNs[n] += prvNow() - start;
+        }
+        groupNs[n] /= (double)ROUNDS * n;
+        groupCritical[n] = DBcriticalCount / ((double)ROUNDS * n);
+
+        DBcriticalCount = 0;
+        for(i = 0; i < ROUNDS; i++){
+            registerTCB(IDBENCH);
+            hostTick();
+            start = prvNow();
+            for(k = 0; k < n; k++){
+                DBworkingSize(&w[k], k, OBJSIZE, LOCVM);
+                memset(w[k].address, (int)i, OBJSIZE);
+                if(DBcommit(&w[k], OBJSIZE, 1) != k)
+                    benchFailed = 1;
+            }
+            singleNs[n] += prvNow() - start;
+        }
+        singleNs[n] /= (double)ROUNDS * n;
+        singleCritical[n] = DBcriticalCount / ((double)ROUNDS * n);
+    }
+    unresgisterTCB(IDBENCH);
+}
+
+int main(){
+    struct hostTask t;
+    int n;
+
+    hostInit();
+    hostCreate(&t, prvBenchTask, IDBENCH, INVM);
+    if(hostRun(&t) != HOSTDONE || benchFailed){
+        printf("FAILED\n");
+        return 1;
+    }
+    for(n = 1; n <= MAXCOMMIT; n++)
+        printf("%d objects: one DBcommit %.1f ns and %.1f critical sections per object, %d single DBcommit %.1f ns and %.1f critical sections per object\n",
+               n, groupNs[n], groupCritical[n], n, singleNs[n], singleCritical[n]);
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * pagebench.c
+ *
+ *  Descriptions: Host benchmark of the paged array objects of PageDB, built with DBPROFILE by the Makefile. Slices of
+ *  growing length are written to an array by DBwriteRange and to a plain object of the same size by a whole DBcommit,
+ *  and the bytes written to FRAM by the commits are counted by DBPROFILE. The times are of the host, only their ratio
+ *  is meaningful. A DBarrayCreate running out of objects is checked to give back its pages and their ids.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <HostTest/hostos.h>
+#include <DataManager/SimpDB.h>
+#include <DataManager/PageDB.h>
+
+#define IDBENCH 4
+#define ARRAYSIZE (PAGESIZE * MAXPAGES)
+#define ROUNDS 20000
+#define NUMLENS 5
+
+static const unsigned int lens[NUMLENS] = {8, PAGESIZE, 2 * PAGESIZE, 4 * PAGESIZE, MAXCOMMIT * PAGESIZE};//at most MAXCOMMIT pages for DBwriteRange
+static double rangeNs[NUMLENS], wholeNs[NUMLENS];
+static unsigned long rangeBytes[NUMLENS], wholeBytes[NUMLENS];
+static int benchFailed;
+static unsigned long seed = 1;
+static uint8_t content[ARRAYSIZE];
+
+/*
+ * description: current time of the host
+ * parameters: none
+ * return: time in ns
+ * */
+static double prvNow(){
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * description: a pseudo-random number
+ * parameters: bound
+ * return: a number below the bound
+ * */
+static unsigned int prvRandom(unsigned int bound){
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % bound;
+}
+
+/*
+ * description: a random offset of a slice, a slice shorter than a page stays in one page
+ * parameters: length of the slice
+ * return: the offset
+ * */
+static unsigned int prvOffset(unsigned int len){
+    if(len < PAGESIZE)
+        return prvRandom(MAXPAGES) * PAGESIZE + prvRandom(PAGESIZE - len + 1);
+    return prvRandom(MAXPAGES - len / PAGESIZE + 1) * PAGESIZE;
+}
+
+/*
+ * description: the task writing the slices, then creating an array with too few objects left
+ * parameters: none
+ * return: none
+ * */
+static void prvBenchTask(){
+    struct working w;
+    double start;
+    size_t freeBytes;
+    unsigned int offset;
+    int array, whole, i, l;
+
+    registerTCB(IDBENCH);
+    hostTick();
+    array = DBarrayCreate(content, ARRAYSIZE);
+    registerTCB(IDBENCH);
+    hostTick();
+    DBworkingSize(&w, -1, ARRAYSIZE, LOCNVM);
+    memset(w.address, 0, ARRAYSIZE);
+    whole = DBcommit(&w, ARRAYSIZE, 1);
+    if(array < 0 || whole < 0){
+        benchFailed = 1;
+        return;
+    }
+
+    for(l = 0; l < NUMLENS; l++){
+        DBwriteBytes = 0;
+        for(i = 0; i < ROUNDS; i++){
+            registerTCB(IDBENCH);
+            hostTick();
+            offset = prvOffset(lens[l]);
+            memset(content, i, lens[l]);
+            start = prvNow();
+            if(DBwriteRange(array, content, offset, lens[l]) != array)
+                benchFailed = 1;
+            rangeNs[l] += prvNow() - start;
+        }
+        rangeBytes[l] = DBwriteBytes / ROUNDS;
+
+        DBwriteBytes = 0;
+        for(i = 0; i < ROUNDS; i++){
+            registerTCB(IDBENCH);
+            hostTick();
+            offset = prvOffset(lens[l]);
+            memset(content, i, lens[l]);
+            start = prvNow();
+            DBworkingSize(&w, whole, ARRAYSIZE, LOCNVM);
+            memcpy(w.address, DBread(whole), ARRAYSIZE);
+            memcpy((uint8_t*)w.address + offset, content, lens[l]);
+            if(DBcommit(&w, ARRAYSIZE, 1) != whole)
+                benchFailed = 1;
+            wholeNs[l] += prvNow() - start;
+        }
+        wholeBytes[l] = DBwriteBytes / ROUNDS;
+        rangeNs[l] /= ROUNDS;
+        wholeNs[l] /= ROUNDS;
+    }
+
+    //the objects left are fewer than the pages and the page table
+    registerTCB(IDBENCH);
+    hostTick();
+    freeBytes = xPortGetFreeHeapSize();
+    if(DBarrayCreate(content, ARRAYSIZE) >= 0 || xPortGetFreeHeapSize() < freeBytes || DBreserve() != whole + 1){
+        printf("the pages of a failed DBarrayCreate are not deleted\n");
+        benchFailed = 1;
+    }
+    unresgisterTCB(IDBENCH);
+}
+
+int main(){
+    struct hostTask t;
+    int l;
+
+    hostInit();
+    hostCreate(&t, prvBenchTask, IDBENCH, INVM);
+    if(hostRun(&t) != HOSTDONE || benchFailed){
+        printf("FAILED\n");
+        return 1;
+    }
+    for(l = 0; l < NUMLENS; l++)
+        printf("%u of %d bytes modified (%.1f%%): DBwriteRange %lu bytes written, %.1f ns, whole DBcommit %lu bytes written, %.1f ns\n",
+               lens[l], ARRAYSIZE, 100.0 * lens[l] / ARRAYSIZE, rangeBytes[l], rangeNs[l], wholeBytes[l], wholeNs[l]);
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * readerbench.c
+ *
+ *  Descriptions: Host benchmark of the cost of readers, built by the Makefile. Up to NUMTASK - 3 reader tasks read
+ *  an object and are switched out, then a writer reads and commits the object. The DBread and DBcommit of the writer
+ *  run almost entirely in critical sections, so their times show how these grow with the readers. The readers are
+ *  registered by DBread, or declared read-only by DBreadOnly and read a snapshot. The times are of the host, only
+ *  their ratios are meaningful.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <HostTest/hostos.h>
+#include <DataManager/SimpDB.h>
+
+#define IDWRITER 2
+#define IDREADER 3 //slot of the first reader
+#define NUMREADER (NUMTASK - IDREADER)
+#define OBJSIZE 8
+#define ROUNDS 100000
+#define NUMCOUNTS 5
+
+static const int counts[NUMCOUNTS] = {0, 1, 2, 4, NUMREADER};
+static double readerSpent, readSpent, commitSpent;
+static long readerReads;
+static int benchFailed, readOnly, objId = -1;
+static long round;
+
+/*
+ * description: current time of the host
+ * parameters: none
+ * return: time in ns
+ * */
+static double prvNow(){
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * description: a reader, switched out between its read and its end
+ * parameters: none
+ * return: none
+ * */
+static void prvReaderTask(){
+    volatile uint8_t sink;
+    double start;
+
+    registerTCB(getTaskID());
+    hostTick();//the snapshot of a read-only reader is taken after the last commit
+    if(readOnly)
+        DBreadOnly();
+    start = prvNow();
+    sink = *(uint8_t*)DBread(objId);
+    readerSpent += prvNow() - start;
+    readerReads++;
+    ( void ) sink;
+    hostYield();
+    unresgisterTCB(getTaskID());
+}
+
+/*
+ * description: the writer, creating the object at its first run, then reading and committing it once in each run
+ * parameters: none
+ * return: none
+ * */
+static void prvWriterTask(){
+    struct working w;
+    volatile uint8_t sink;
+    double start;
+
+    registerTCB(IDWRITER);
+    hostTick();
+    if(objId < 0){
+        DBworkingSize(&w, -1, OBJSIZE, LOCVM);
+        memset(w.address, 0, OBJSIZE);
+        objId = DBcommit(&w, OBJSIZE, 1);
+        if(objId < 0)
+            benchFailed = 1;
+        unresgisterTCB(IDWRITER);
+        return;
+    }
+
+    start = prvNow();
+    sink = *(uint8_t*)DBread(objId);
+    readSpent += prvNow() - start;
+    ( void ) sink;
+    DBworkingSize(&w, objId, OBJSIZE, LOCVM);
+    memset(w.address, (int)round, OBJSIZE);
+    start = prvNow();
+    if(DBcommit(&w, 0, 1) != objId)
+        benchFailed = 1;
+    commitSpent += prvNow() - start;
+    unresgisterTCB(IDWRITER);
+}
+
+int main(){
+    struct hostTask writer, readers[NUMREADER];
+    int c, r, result;
+
+    hostInit();
+    hostCreate(&writer, prvWriterTask, IDWRITER, INVM);
+    for(r = 0; r < NUMREADER; r++)
+        hostCreate(&readers[r], prvReaderTask, IDREADER + r, INVM);
+    if(hostRun(&writer) != HOSTDONE || benchFailed){
+        printf("FAILED\n");
+        return 1;
+    }
+
+    for(c = 0; c < 2 * NUMCOUNTS; c++){
+        readOnly = (c >= NUMCOUNTS);
+        readerSpent = 0;
+        readerReads = 0;
+        readSpent = 0;
+        commitSpent = 0;
+        for(round = 0; round < ROUNDS; round++){
+            for(r = 0; r < counts[c % NUMCOUNTS]; r++)
+                if(hostRun(&readers[r]) != HOSTYIELD)
+                    benchFailed = 1;
+            if(hostRun(&writer) != HOSTDONE)
+                benchFailed = 1;
+            for(r = 0; r < counts[c % NUMCOUNTS]; r++){
+                result = hostRun(&readers[r]);
+                if(result != HOSTDONE && result != HOSTRERUN)
+                    benchFailed = 1;
+            }
+        }
+        if(benchFailed){
+            printf("FAILED\n");
+            return 1;
+        }
+        printf("%d %sreaders: DBread of the readers %.1f ns, DBread of the writer %.1f ns, DBcommit %.1f ns\n",
+               counts[c % NUMCOUNTS], readOnly? "read-only " : "", readerReads? readerSpent / readerReads : 0,
+               readSpent / ROUNDS, commitSpent / ROUNDS);
+    }
+    return 0;
+}
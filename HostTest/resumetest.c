@@ -0,0 +1,167 @@
+/*
+ * resumetest.c
+ *
+ *  Descriptions: Failure-injection test of DBcommitLarge with DBRESUME. The power fails at every copy of a large commit,
+ *  at the same copy after each boot, and the task has to finish: a rerun task returns the commit finished by DBrecovery
+ *  and a lengthy task finishes its own commit. A run makes one or two large commits, the rerun of a run gets the ids of the
+ *  commits finished before. The data manager is included to clear its SRAM state at each failure.
+ */
+
+#include "../DataManager/SimpDB.c"
+#include <stdio.h>
+#include <stdlib.h>
+#include <HostTest/hostos.h>
+
+#define IDTEST 4
+#define LARGESIZE (RESUMECHUNK + RESUMECHUNK / 2)//copied in two chunks
+#define MAXBOOTS 8
+#define MAXCALLS 2
+
+static int testCommits;//large commits of each run
+static int testId[MAXCALLS];//ids committed by the task, -1 to create one
+static int testPattern;//first byte of the data written by the first commit, the next commit writes the next pattern
+static int testResult[MAXCALLS];
+static int testAttempts;
+
+/*
+ * description: the task writing large data objects in one run
+ * parameters: none
+ * return: none
+ * */
+static void prvLargeTask(){
+    struct working w;
+    int c, i;
+
+    registerTCB(IDTEST);
+    testAttempts++;
+    for(c = 0; c < testCommits; c++){
+        DBworkingSize(&w, testId[c], LARGESIZE, LOCNVM);
+        for(i = 0; i < LARGESIZE; i++)
+            ((uint8_t*)w.address)[i] = (uint8_t)(testPattern + c + i);
+        hostTick();
+        testResult[c] = DBcommitLarge(&w, LARGESIZE);
+    }
+    unresgisterTCB(IDTEST);
+}
+
+/*
+ * description: the SRAM state of the data manager lost by a power failure
+ * parameters: none
+ * return: none
+ * */
+static void prvSramLoss(){
+    memset(commitLock, 0, sizeof(commitLock));
+    memset(WorkingVMIndex, 0, sizeof(WorkingVMIndex));
+    memset(Doomed, 0, sizeof(Doomed));
+    memset(InTx, 0, sizeof(InTx));
+}
+
+/*
+ * description: check the committed data and the heap
+ * parameters: id of the data, first byte of the data, blocks expected in the heap
+ * return: 0 if consistent, -1 otherwise
+ * */
+static int prvCheck(int id, int pattern, long blocks){
+    const uint8_t* data;
+    int i;
+
+    if(id < 0 || id >= NUMOBJ || DB[id].size != LARGESIZE || accessData(id) == NULL)
+        return -1;
+    data = accessData(id);
+    for(i = 0; i < LARGESIZE; i++)
+        if(data[i] != (uint8_t)(pattern + i))
+            return -1;
+    if(CHECK_BIT(commitLock[id/16], id%16))
+        return -1;
+    return (hostBlocks() == blocks)? 0 : -1;
+}
+
+/*
+ * description: run the task with the power failing at the same copy after every boot
+ * parameters: the task, copy to cut
+ * return: number of boots until the task is done, -1 if it is never done
+ * */
+static int prvRunCut(struct hostTask* t, unsigned long copy){
+    int boots;
+
+    for(boots = 1; boots <= MAXBOOTS; boots++){
+        hostFailAt(copy);
+        if(hostRun(t) != HOSTFAILED)
+            return boots;
+        hostReboot(t, 1);
+    }
+    return -1;
+}
+
+/*
+ * description: cut the commits of a task at each copy in turn
+ * parameters: name, location of the task, large commits of each run, 1 to create the data in every run
+ * return: number of failed cases
+ * */
+static int prvScenario(const char* name, int location, int commits, int create){
+    struct hostTask t;
+    unsigned long copy;
+    int boots, c, failed = 0, id[MAXCALLS], cases = 0, done;
+    long blocks;
+
+    hostCreate(&t, prvLargeTask, IDTEST, location);
+    //the data is created without failures
+    testCommits = commits;
+    for(c = 0; c < commits; c++)
+        testId[c] = -1;
+    testPattern = 0;
+    if(hostRun(&t) != HOSTDONE){
+        printf("%s: the data is not created\n", name);
+        return 1;
+    }
+    for(c = 0; c < commits; c++)
+        id[c] = testResult[c];
+    blocks = hostBlocks();
+
+    for(copy = 1; ; copy++){
+        for(c = 0; c < commits; c++)
+            testId[c] = create? -1 : id[c];
+        testPattern = (int)copy;
+        testAttempts = 0;
+        boots = prvRunCut(&t, copy);
+        if(boots == 1){//not cut, every copy has been tried
+            hostFailAt(0);
+            break;
+        }
+        cases++;
+        done = (boots > 0);
+        for(c = 0; c < commits; c++)
+            if(testResult[c] < 0 || (create == 0 && testResult[c] != id[c]) || (c > 0 && testResult[c] == testResult[0]))
+                done = 0;
+        if(!done){
+            printf("%s: cut at copy %lu, the task is not done after %d boots\n", name, copy, MAXBOOTS);
+            failed++;
+            break;
+        }
+        if(create)
+            blocks += commits;//new data for each run
+        for(c = 0; c < commits; c++)
+            if(prvCheck(testResult[c], testPattern + c, blocks) < 0){
+                printf("%s: cut at copy %lu, the data or the heap is inconsistent\n", name, copy);
+                failed++;
+                break;
+            }
+    }
+    printf("%s: %d cuts, %d failed\n", name, cases, failed);
+    return failed;
+}
+
+int main(){
+    int failed = 0;
+
+    hostSramLoss = prvSramLoss;
+    hostInit();
+    failed += prvScenario("rerun task", INVM, 1, 0);
+    failed += prvScenario("rerun task creating data", INVM, 1, 1);
+    failed += prvScenario("rerun task creating two data", INVM, 2, 1);
+    failed += prvScenario("lengthy task", INNVM, 1, 0);
+    failed += prvScenario("lengthy task creating data", INNVM, 1, 1);
+    failed += prvScenario("lengthy task creating two data", INNVM, 2, 1);
+    printf(failed? "FAILED\n" : "PASSED\n");
+    return failed? 1 : 0;
+}
@@ -0,0 +1,139 @@
+/*
+ * slabbench.c
+ *
+ *  Descriptions: Host benchmark of the allocation of versions, built with DBSLAB (slabbench) and with heap_4 only
+ *  (heapbench) by the Makefile. The objects are committed with changing sizes while kernel objects come and go
+ *  in the heap, then the latency of DBalloc/DBfree and DBcommit and the fragmentation of the heap are reported.
+ *  The times are of the host, only their ratio across the builds is meaningful.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <HostTest/hostos.h>
+#include <DataManager/SimpDB.h>
+#include <DataManager/slab.h>
+
+#define IDBENCH 4
+#define MAXSIZE 120 //largest version, all the sizes fit the classes of DBSLAB
+#define KERNELBLOCKS 8 //kernel objects alive at the same time
+#define KERNELEVERY 16 //commits between the changes of the kernel objects
+#define ROUNDS 100000
+#define SAMPLEEVERY 1000 //commits between the samples of the largest free block
+
+static double allocNs, commitNs;
+static size_t minLargest = (size_t)-1;
+static int benchFailed;
+static unsigned long seed = 1;
+
+/*
+ * description: current time of the host
+ * parameters: none
+ * return: time in ns
+ * */
+static double prvNow(){
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * description: a pseudo-random number, the same sequence for both builds
+ * parameters: bound
+ * return: a number below the bound
+ * */
+static unsigned int prvRandom(unsigned int bound){
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % bound;
+}
+
+/*
+ * description: the task committing the objects with random sizes, with kernel objects allocated and freed in between
+ * parameters: none
+ * return: none
+ * */
+static void prvBenchTask(){
+    struct working w;
+    void* kernel[KERNELBLOCKS] = {NULL};
+    void* block = NULL;
+    double start, allocSpent = 0, commitSpent = 0;
+    unsigned int size;
+    long i;
+    int id, k;
+
+    for(id = 0; id < NUMOBJ; id++){
+        registerTCB(IDBENCH);
+        hostTick();
+        DBworkingSize(&w, -1, MAXSIZE, LOCVM);
+        if(w.address == NULL || DBcommit(&w, MAXSIZE, 1) != id)
+            benchFailed = 1;
+    }
+
+    for(i = 0; i < ROUNDS && !benchFailed; i++){
+        id = prvRandom(NUMOBJ);
+        size = 8 + prvRandom(MAXSIZE - 8);
+
+        //an allocation of the size of the new version and a free, as in a commit
+        start = prvNow();
+        DBalloc(VERSIONSIZE(size), &block);
+        DBfree(&block);
+        allocSpent += prvNow() - start;
+
+        registerTCB(IDBENCH);
+        hostTick();
+        DBworkingSize(&w, id, size, LOCNVM);
+        if(w.address == NULL){
+            benchFailed = 1;
+            break;
+        }
+        memset(w.address, (int)i, size);
+        start = prvNow();
+        if(DBcommit(&w, size, 1) != id)
+            benchFailed = 1;
+        commitSpent += prvNow() - start;
+
+        if(i % KERNELEVERY == 0){//a task or a queue is created or deleted
+            k = prvRandom(KERNELBLOCKS);
+            if(kernel[k] != NULL){
+                vPortFree(kernel[k]);
+                kernel[k] = NULL;
+            }
+            else
+                kernel[k] = pvPortMalloc(40 + prvRandom(360));
+        }
+        if(i % SAMPLEEVERY == 0 && xPortGetLargestFreeBlock() < minLargest)
+            minLargest = xPortGetLargestFreeBlock();
+    }
+    allocNs = allocSpent / ROUNDS;
+    commitNs = commitSpent / ROUNDS;
+    for(k = 0; k < KERNELBLOCKS; k++)
+        vPortFree(kernel[k]);
+    unresgisterTCB(IDBENCH);
+}
+
+int main(){
+    struct hostTask t;
+    size_t largest, freeBytes;
+    int id, slab = 0;
+#ifdef DBSLAB
+    const char* name = "DBSLAB";
+#else
+    const char* name = "heap_4";
+#endif
+
+    hostInit();
+    hostCreate(&t, prvBenchTask, IDBENCH, INVM);
+    if(hostRun(&t) != HOSTDONE || benchFailed){
+        printf("%s: FAILED\n", name);
+        return 1;
+    }
+    for(id = 0; id < NUMOBJ; id++)
+        slab += DBslab(accessData(id));
+    largest = xPortGetLargestFreeBlock();
+    freeBytes = xPortGetFreeHeapSize();
+    printf("%s, %d commits of 8 to %d bytes: DBalloc+DBfree %.1f ns, DBcommit %.1f ns, %d of %d versions in the slab, "
+           "heap %lu bytes free, largest free block %lu (%.1f%% fragmented), smallest largest block during the run %lu\n",
+           name, ROUNDS, MAXSIZE, allocNs, commitNs, slab, NUMOBJ, (unsigned long)freeBytes, (unsigned long)largest,
+           100.0 * (1.0 - (double)largest / freeBytes), (unsigned long)minLargest);
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * snapshotbench.c
+ *
+ *  Descriptions: Host benchmark of a read-only aggregation against concurrent writers, built with 3 versions by the
+ *  Makefile. The aggregator sums AGGOBJ objects and is switched out halfway, while a writer moves a unit between two
+ *  of them, so that the sum stays the same. The aggregator reads by DBread and checks its reads by DBvalidate, or
+ *  reads a snapshot by DBreadAt. The reruns, the sums seen and the times of the host are reported.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <HostTest/hostos.h>
+#include <DataManager/SimpDB.h>
+
+#define IDAGG 2
+#define IDWRITER 3
+#define AGGOBJ MAXSNAPSHOT //objects summed, all pinned by a snapshot
+#define INITIAL 1000
+#define ROUNDS 20000
+
+enum{
+    MODEREAD = 0,
+    MODESNAPSHOT,
+    NUMMODES
+};
+
+static int mode, benchFailed;
+static unsigned long seed = 1;
+static long runs, missed, inconsistent;
+static double spent;
+
+/*
+ * description: current time of the host
+ * parameters: none
+ * return: time in ns
+ * */
+static double prvNow(){
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * description: a pseudo-random number
+ * parameters: bound
+ * return: a number below the bound
+ * */
+static unsigned int prvRandom(unsigned int bound){
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % bound;
+}
+
+/*
+ * description: the aggregator summing the objects, switched out after half of them
+ * parameters: none
+ * return: none
+ * */
+static void prvAggregatorTask(){
+    const long* value;
+    unsigned long t = 0;
+    double start;
+    long sum = 0;
+    int id;
+
+    runs++;
+    registerTCB(IDAGG);
+    start = prvNow();
+    if(mode == MODESNAPSHOT)
+        t = DBsnapshotBegin(timeCounter);
+    for(id = 0; id < AGGOBJ; id++){
+        if(id == AGGOBJ / 2){
+            spent += prvNow() - start;
+            hostYield();
+            start = prvNow();
+        }
+        value = (mode == MODESNAPSHOT)? DBreadAt(id, t) : DBread(id);
+        if(value == NULL){//the version of the snapshot is no longer kept
+            missed++;
+            break;
+        }
+        sum += *value;
+    }
+    if(mode == MODESNAPSHOT)
+        DBsnapshotEnd();
+    else
+        DBvalidate();//a run with inconsistent reads is rerun here
+    spent += prvNow() - start;
+    if(id == AGGOBJ && sum != (long)INITIAL * AGGOBJ)
+        inconsistent++;
+    unresgisterTCB(IDAGG);
+}
+
+/*
+ * description: the writer moving a unit between two random objects by one DBcommit
+ * parameters: none
+ * return: none
+ * */
+static void prvWriterTask(){
+    struct working w[2];
+    int from = prvRandom(AGGOBJ), to = (from + 1 + prvRandom(AGGOBJ - 1)) % AGGOBJ;
+
+    registerTCB(IDWRITER);
+    hostTick();
+    DBworkingSize(&w[0], from, sizeof(long), LOCVM);
+    DBworkingSize(&w[1], to, sizeof(long), LOCVM);
+    *(long*)w[0].address = *(const long*)DBread(from) - 1;
+    *(long*)w[1].address = *(const long*)DBread(to) + 1;
+    if(DBcommit(w, sizeof(long), 2) < 0)
+        benchFailed = 1;
+    unresgisterTCB(IDWRITER);
+}
+
+/*
+ * description: the task creating the objects
+ * parameters: none
+ * return: none
+ * */
+static void prvCreateTask(){
+    struct working w;
+    int id;
+
+    for(id = 0; id < AGGOBJ; id++){
+        registerTCB(IDWRITER);
+        hostTick();
+        DBworkingSize(&w, -1, sizeof(long), LOCVM);
+        *(long*)w.address = INITIAL;
+        if(DBcommit(&w, sizeof(long), 1) != id)
+            benchFailed = 1;
+    }
+    unresgisterTCB(IDWRITER);
+}
+
+int main(){
+    struct hostTask create, aggregator, writer;
+    const char* names[NUMMODES] = {"DBread", "DBreadAt"};
+    long i;
+    int result;
+
+    hostInit();
+    hostCreate(&create, prvCreateTask, IDWRITER, INVM);
+    hostCreate(&aggregator, prvAggregatorTask, IDAGG, INVM);
+    hostCreate(&writer, prvWriterTask, IDWRITER, INVM);
+    if(hostRun(&create) != HOSTDONE || benchFailed){
+        printf("FAILED\n");
+        return 1;
+    }
+
+    for(mode = 0; mode < NUMMODES; mode++){
+        runs = 0;
+        missed = 0;
+        inconsistent = 0;
+        spent = 0;
+        for(i = 0; i < ROUNDS; i++){
+            //a rerun is switched out halfway again, and the writer commits again
+            do{
+                if(hostRun(&aggregator) != HOSTYIELD)
+                    benchFailed = 1;
+                if(hostRun(&writer) != HOSTDONE)
+                    benchFailed = 1;
+                result = hostRun(&aggregator);
+            }while(result == HOSTRERUN && !benchFailed);
+            if(result != HOSTDONE || benchFailed){
+                printf("FAILED\n");
+                return 1;
+            }
+        }
+        printf("%s, %d objects with a writer committing in between: %.2f runs and %.1f ns for each sum, %ld sums missed a version, %ld sums inconsistent\n",
+               names[mode], AGGOBJ, (double)runs / ROUNDS, spent / ROUNDS, missed, inconsistent);
+        if(inconsistent > 0)
+            benchFailed = 1;
+    }
+    return benchFailed;
+}
@@ -0,0 +1,61 @@
+/*
+ * FreeRTOS.h
+ *
+ *  Descriptions: Host stand-in of the kernel header, only the types and macros used by the data manager
+ */
+
+#ifndef HOSTTEST_FREERTOS_H_
+#define HOSTTEST_FREERTOS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <FreeRTOSConfig.h>
+
+typedef uint16_t StackType_t;
+typedef unsigned short UBaseType_t;
+typedef short BaseType_t;
+typedef uint32_t TickType_t;
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+typedef struct { void* pvItems[4]; TickType_t xItemValue; } ListItem_t;
+
+#define portSTACK_GROWTH (-1)
+#define portUSING_MPU_WRAPPERS 0
+#define portBYTE_ALIGNMENT 8 //pointers of the host in the blocks of heap_4
+#define portBYTE_ALIGNMENT_MASK 7
+#define portCRITICAL_NESTING_IN_TCB 0
+#define tskSTATIC_AND_DYNAMIC_ALLOCATION_POSSIBLE 0
+#define INCLUDE_xTaskAbortDelay 0
+#define configUSE_NEWLIB_REENTRANT 0
+#define configUSE_TASK_NOTIFICATIONS 1
+#define configSUPPORT_DYNAMIC_ALLOCATION 1
+#define pdPASS 1
+#define pdFAIL 0
+#define pdTRUE 1
+#define pdFALSE 0
+
+void vPortEnterCritical(void);
+void vPortExitCritical(void);
+#define taskENTER_CRITICAL() vPortEnterCritical()
+#define taskEXIT_CRITICAL() vPortExitCritical()
+#define taskDISABLE_INTERRUPTS()
+#define portYIELD_FROM_ISR(x)
+
+void *pvPortMalloc(size_t xWantedSize);
+void vPortFree(void *pv);
+void pvInitHeapVar();
+size_t xPortGetFreeHeapSize(void);
+size_t xPortGetLargestFreeBlock(void);
+
+//hooks of heap_4, the blocks are counted to find the leaked versions
+void hostTraceMalloc(void* pv);
+void hostTraceFree(void* pv);
+#define mtCOVERAGE_TEST_MARKER()
+#define traceMALLOC(pvAddress, uiSize) hostTraceMalloc(pvAddress)
+#define traceFREE(pvAddress, uiSize) hostTraceFree(pvAddress)
+
+//Timer B0 of DBPROFILE
+extern volatile unsigned int TB0R;
+
+#endif /* HOSTTEST_FREERTOS_H_ */
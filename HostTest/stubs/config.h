@@ -0,0 +1,24 @@
+/*
+ * config.h
+ *
+ *  Descriptions: Host configuration, the parameters of the device are kept except the ones set by the Makefile
+ */
+
+#ifndef HOSTTEST_CONFIG_H_
+#define HOSTTEST_CONFIG_H_
+
+#include "../../config.h"
+
+//number of data objects of a benchmark build
+#ifdef HOSTNUMOBJ
+#undef NUMOBJ
+#define NUMOBJ HOSTNUMOBJ
+#endif
+
+//number of versions of a test build
+#ifdef HOSTNUMVERSION
+#undef NUMVERSION
+#define NUMVERSION HOSTNUMVERSION
+#endif
+
+#endif /* HOSTTEST_CONFIG_H_ */
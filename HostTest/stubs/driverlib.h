@@ -0,0 +1,23 @@
+/*
+ * driverlib.h
+ *
+ *  Descriptions: Host stand-in of the driver library, the CRC32 module and the interrupt state used by the data manager
+ */
+
+#ifndef HOSTTEST_DRIVERLIB_H_
+#define HOSTTEST_DRIVERLIB_H_
+
+#include <stdint.h>
+
+#define CRC32_MODE 1
+void CRC32_setSeed(uint32_t seed, uint8_t crcMode);
+void CRC32_set8BitData(uint8_t dataIn, uint8_t crcMode);
+void CRC32_set16BitData(uint16_t dataIn, uint8_t crcMode);
+uint32_t CRC32_getResult(uint8_t crcMode);
+
+typedef unsigned short istate_t;
+istate_t __get_interrupt_state(void);
+void __set_interrupt_state(istate_t state);
+void __disable_interrupt(void);
+
+#endif /* HOSTTEST_DRIVERLIB_H_ */
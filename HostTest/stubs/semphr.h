@@ -0,0 +1,7 @@
+/*
+ * semphr.h
+ *
+ *  Descriptions: Host stand-in of the semaphore header
+ */
+
+#include <task.h>
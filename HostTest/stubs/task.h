@@ -0,0 +1,19 @@
+/*
+ * task.h
+ *
+ *  Descriptions: Host stand-in of the task API used by the data manager
+ */
+
+#ifndef HOSTTEST_TASK_H_
+#define HOSTTEST_TASK_H_
+
+#include <FreeRTOS.h>
+
+#define taskYIELD()
+#define tskIDLE_PRIORITY 0
+
+void vTaskSuspendAll(void);
+BaseType_t xTaskResumeAll(void);
+void vTaskDelay(TickType_t xTicksToDelay);
+
+#endif /* HOSTTEST_TASK_H_ */
@@ -0,0 +1,191 @@
+/*
+ * txbench.c
+ *
+ *  Descriptions: Host benchmark of the transaction API against the per-task model, built by the Makefile. Each
+ *  transaction reads an input, runs the 32-bit math of the math32 demo task and commits the result. In every
+ *  CONFLICTEVERY transactions a writer commits the input halfway, so the transaction is retried. With the per-task
+ *  model a transaction is a run of a task, which is rerun from its start. With DBtx* one task runs all the
+ *  transactions and retries from DBtxBegin. The times are of the host, only their ratio is meaningful.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <HostTest/hostos.h>
+#include <DataManager/SimpDB.h>
+
+#define IDTASK 2
+#define IDWRITER 3
+#define ITERMATH 50 //ITERMATH32 of the demo
+#define CONFLICTEVERY 4
+#define ROUNDS 50000
+
+static int benchFailed, inputId = -1, resultId = -1;
+static long round, retries;
+static int conflicted;//the writer has committed in the current round
+
+/*
+ * description: current time of the host
+ * parameters: none
+ * return: time in ns
+ * */
+static double prvNow(){
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * description: the computation of the math32 demo task
+ * parameters: the input
+ * return: the result
+ * */
+static long prvMath(long input){
+    volatile long result32[4];
+    int i;
+
+    result32[0] = input;
+    result32[1] = 14567;
+    for(i = 0; i < ITERMATH; i++){
+        result32[2] = result32[0] + result32[1];
+        result32[1] = result32[0] * result32[2];
+        result32[3] = result32[1] / (result32[2] | 1);
+    }
+    return result32[3];
+}
+
+/*
+ * description: a transaction of the per-task model, the task is rerun from here if its commit fails
+ * parameters: none
+ * return: none
+ * */
+static void prvTaskModel(){
+    struct working w;
+    long input;
+
+    registerTCB(IDTASK);
+    hostTick();
+    input = *(const long*)DBread(inputId);
+    if(round % CONFLICTEVERY == 0 && !conflicted)
+        hostYield();//the writer commits the input
+    else if(conflicted)
+        retries++;
+    DBworkingSize(&w, resultId, sizeof(long), LOCVM);
+    *(long*)w.address = prvMath(input);
+    if(DBcommit(&w, 0, 1) != resultId)
+        benchFailed = 1;
+    unresgisterTCB(IDTASK);
+}
+
+/*
+ * description: a task running all the transactions with DBtx*, each one is retried from DBtxBegin if it fails
+ * parameters: none
+ * return: none
+ * */
+static void prvTxModel(){
+    struct transaction tx;
+    long input, *result;
+
+    registerTCB(IDTASK);
+    for(round = 0; round < ROUNDS; round++){
+        conflicted = 0;
+        while(1){
+            hostTick();
+            DBtxBegin(&tx);
+            input = *(const long*)DBtxRead(&tx, inputId);
+            if(round % CONFLICTEVERY == 0 && !conflicted)
+                hostYield();
+            result = DBtxWrite(&tx, resultId, sizeof(long));
+            if(result == NULL){
+                benchFailed = 1;
+                DBtxAbort(&tx);
+                break;
+            }
+            *result = prvMath(input);
+            if(DBtxCommit(&tx) == 0)
+                break;
+            retries++;
+        }
+    }
+    unresgisterTCB(IDTASK);
+}
+
+/*
+ * description: the writer committing the input, it creates the objects at its first run
+ * parameters: none
+ * return: none
+ * */
+static void prvWriterTask(){
+    struct working w;
+
+    registerTCB(IDWRITER);
+    hostTick();
+    if(inputId < 0){
+        DBworkingSize(&w, -1, sizeof(long), LOCVM);
+        *(long*)w.address = 43125;
+        inputId = DBcommit(&w, sizeof(long), 1);
+        registerTCB(IDWRITER);
+        hostTick();
+        DBworkingSize(&w, -1, sizeof(long), LOCVM);
+        *(long*)w.address = 0;
+        resultId = DBcommit(&w, sizeof(long), 1);
+        if(inputId < 0 || resultId < 0)
+            benchFailed = 1;
+    }
+    else{
+        DBworkingSize(&w, inputId, sizeof(long), LOCVM);
+        *(long*)w.address = 43125 + round;
+        if(DBcommit(&w, 0, 1) != inputId)
+            benchFailed = 1;
+    }
+    conflicted = 1;
+    unresgisterTCB(IDWRITER);
+}
+
+int main(){
+    struct hostTask task, tx, writer;
+    double start, taskNs, txNs;
+    long taskRetries;
+    int result;
+
+    hostInit();
+    hostCreate(&task, prvTaskModel, IDTASK, INVM);
+    hostCreate(&tx, prvTxModel, IDTASK, INVM);
+    hostCreate(&writer, prvWriterTask, IDWRITER, INVM);
+    if(hostRun(&writer) != HOSTDONE || benchFailed){
+        printf("FAILED\n");
+        return 1;
+    }
+
+    //a run of a task stands for its creation by the task manager
+    start = prvNow();
+    for(round = 0; round < ROUNDS && !benchFailed; round++){
+        conflicted = 0;
+        while((result = hostRun(&task)) != HOSTDONE){
+            if(result == HOSTYIELD && hostRun(&writer) != HOSTDONE)
+                benchFailed = 1;
+            else if(result != HOSTYIELD && result != HOSTRERUN)
+                benchFailed = 1;
+            if(benchFailed)
+                break;
+        }
+    }
+    taskNs = (prvNow() - start) / ROUNDS;
+    taskRetries = retries;
+
+    retries = 0;
+    start = prvNow();
+    while((result = hostRun(&tx)) == HOSTYIELD && !benchFailed)
+        if(hostRun(&writer) != HOSTDONE)
+            benchFailed = 1;
+    txNs = (prvNow() - start) / ROUNDS;
+    if(result != HOSTDONE || benchFailed){
+        printf("FAILED\n");
+        return 1;
+    }
+    printf("per-task model, %d transactions with a conflict in every %d: %.1f ns each, %ld reruns of the task\n",
+           ROUNDS, CONFLICTEVERY, taskNs, taskRetries);
+    printf("DBtx*, %d transactions with a conflict in every %d: %.1f ns each, %ld retries from DBtxBegin\n",
+           ROUNDS, CONFLICTEVERY, txNs, retries);
+    return 0;
+}
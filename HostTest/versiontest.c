@@ -0,0 +1,131 @@
+/*
+ * versiontest.c
+ *
+ *  Descriptions: Test of the older versions kept with NUMVERSION > 2, built for 2 and 3 versions by the Makefile.
+ *  A reader reads an object, a writer commits to it and to a second object, then the reader reads the second object
+ *  and commits. With 3 versions the reader is served the version of the second object before the writer and commits,
+ *  with 2 versions it reads the writer's version, which is too new for the first read, and is rerun.
+ */
+
+#include <stdio.h>
+#include <HostTest/hostos.h>
+#include <DataManager/SimpDB.h>
+
+#define IDREADER 4
+#define IDWRITER 5
+#define IDPREP 6
+#define OBJSIZE 8
+#define PREPCOMMITS 4 //commits to the third object, so that the writer is serialized after the second read version
+
+enum{
+    OBJA = 0,
+    OBJB,
+    OBJC,
+    OBJD,
+    NUMTEST
+};
+
+static int testIds[NUMTEST];
+static int readerResult;
+static uint8_t readerSeen;//first byte of the second object read by the reader
+
+/*
+ * description: commit a working space of the current task
+ * parameters: id of the data or -1 to create it, value of its bytes
+ * return: the id of the data, -1 for failure
+ * */
+static int prvWrite(int id, int value){
+    struct working w;
+
+    DBworkingSize(&w, id, OBJSIZE, LOCVM);
+    memset(w.address, value, OBJSIZE);
+    return DBcommit(&w, OBJSIZE, 1);
+}
+
+/*
+ * description: the task creating the objects, the third one is committed again to move its version ahead
+ * parameters: none
+ * return: none
+ * */
+static void prvPrepTask(){
+    int i;
+
+    for(i = 0; i < NUMTEST; i++){
+        registerTCB(IDPREP);
+        hostTick();
+        testIds[i] = prvWrite(-1, 0);
+    }
+    for(i = 0; i < PREPCOMMITS; i++){
+        registerTCB(IDPREP);
+        hostTick();
+        prvWrite(testIds[OBJD], i);
+    }
+    unresgisterTCB(IDPREP);
+}
+
+/*
+ * description: the reader, preempted by the writer between its two reads
+ * parameters: none
+ * return: none
+ * */
+static void prvReaderTask(){
+    const uint8_t* data;
+
+    registerTCB(IDREADER);
+    data = DBread(testIds[OBJA]);
+    hostYield();
+    data = DBread(testIds[OBJB]);
+    readerSeen = data[0];
+    hostTick();
+    readerResult = prvWrite(testIds[OBJC], readerSeen);
+    unresgisterTCB(IDREADER);
+}
+
+/*
+ * description: the writer committing the first, the second and the third object atomically
+ * parameters: none
+ * return: none
+ * */
+static void prvWriterTask(){
+    struct working w[3];
+    int i, ids[3] = {testIds[OBJA], testIds[OBJB], testIds[OBJD]};
+
+    registerTCB(IDWRITER);
+    hostTick();
+    for(i = 0; i < 3; i++){
+        DBworkingSize(&w[i], ids[i], OBJSIZE, LOCVM);
+        memset(w[i].address, 0xFF, OBJSIZE);
+    }
+    if(DBcommit(w, OBJSIZE, 3) < 0)
+        readerResult = -2;
+    unresgisterTCB(IDWRITER);
+}
+
+int main(){
+    struct hostTask prep, reader, writer;
+    int result, expected;
+
+    hostInit();
+    hostCreate(&prep, prvPrepTask, IDPREP, INVM);
+    hostCreate(&reader, prvReaderTask, IDREADER, INVM);
+    hostCreate(&writer, prvWriterTask, IDWRITER, INVM);
+    if(hostRun(&prep) != HOSTDONE){
+        printf("%d versions: the objects are not created\n", NUMVERSION);
+        return 1;
+    }
+
+    readerResult = -1;
+    if(hostRun(&reader) != HOSTYIELD || hostRun(&writer) != HOSTDONE || readerResult == -2){
+        printf("%d versions: the writer is not done\n", NUMVERSION);
+        return 1;
+    }
+    result = hostRun(&reader);
+    expected = (NUMVERSION > 2)? HOSTDONE : HOSTRERUN;
+    printf("%d versions: the reader %s\n", NUMVERSION, (result == HOSTDONE)? "commits" : "is rerun");
+    if(result != expected || (result == HOSTDONE && (readerResult != testIds[OBJC] || readerSeen != 0))){
+        printf("FAILED\n");
+        return 1;
+    }
+    printf("PASSED\n");
+    return 0;
+}
@@ -12,24 +12,6 @@
 
 void taskRerun();
 
-#pragma NOINIT(RecreateTime)
-static unsigned short RecreateTime[NUMTASK];// record how many times a unfinished task is recreated
-/* Used for rerunning unfinished tasks */
-#pragma NOINIT(unfinished)
-static unsigned short unfinished[NUMTASK];// 1: running, others for invalid
-#pragma NOINIT(address)
-static void* address[NUMTASK];// Function address of tasks
-#pragma NOINIT(priority)
-static unsigned short priority[NUMTASK];
-#pragma NOINIT(TCBNum)
-static unsigned short TCBNum[NUMTASK];
-#pragma NOINIT(TCBAdd)
-static void* TCBAdd[NUMTASK];// TCB address of tasks
-#pragma NOINIT(schedulerTask)
-static int schedulerTask[NUMTASK];// if it is schduler's task, we don't need to recreate it because the scheduler does
-#pragma NOINIT(tID)
-static int tID[NUMTASK];// Function address of tasks
-
 void resetTasks();
 void taskRerun();
 void markCommit();
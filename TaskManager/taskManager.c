@@ -111,6 +111,25 @@ extern tskTCB * volatile pxCurrentTCB;
 #pragma NOINIT(TBuffer)
 static unsigned char TBuffer[NUMTASK][sizeof( TCB_t )];
 
+//Indicator for recovery
+#pragma NOINIT(Tallocation)
+static unsigned char Tallocation[NUMTASK];
+#pragma NOINIT(Running)
+static unsigned char Running[NUMTASK];
+
+
+//maintain all NVM tasks
+#pragma NOINIT(SBuffer)//their stack buffer
+static unsigned char SBuffer[NUMTASK][configMINIMAL_STACK_SIZE*sizeof( StackType_t)];//12*140
+#pragma NOINIT(HBuffer)//heap buffers
+static unsigned char HBuffer[NUMTASK][HEAPBUFF];
+#pragma NOINIT(HIndex)//indexes for each buffer usage
+static unsigned int HIndex[NUMTASK];
+#pragma NOINIT(DBuffer)//data buffers
+static unsigned char DBuffer[NUMTASK][DATABUFF];
+#pragma NOINIT(DIndex)//indexes for each buffer usage
+static unsigned int DIndex[NUMTASK];
+
 /* used to recover tasks */
 void setRunning(int taskID)
 {
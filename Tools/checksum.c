@@ -0,0 +1,53 @@
+/*
+ * checksum.c
+ *
+ *  Descriptions: Implementation of the CRC32 of data objects
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <driverlib.h>
+#include "checksum.h"
+
+/*
+ * description: compute the CRC32 of the data
+ * parameters: data, size in terms of bytes
+ * return: the CRC32
+ * note: the CRC32 module is shared by all tasks, so the data are fed in chunks of CHECKSUM_CHUNK bytes with interrupts disabled,
+ *       and each chunk continues from the result of the previous one. The data should be word aligned. The interrupt state
+ *       is saved and restored rather than using the critical sections of the tasks, as the write back of DBCACHE seals
+ *       the data from the ADC interrupt.
+ * */
+uint32_t checksum(const void* data, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFF;
+#ifdef CRCSOFTWARE
+    const uint8_t* p = data;
+    int bit;
+
+    while(size-- > 0){
+        crc ^= *p++;
+        for(bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+#else
+    const uint16_t* p = data;
+    size_t chunk;
+    istate_t state;
+
+    while(size > 0){
+        chunk = (size < CHECKSUM_CHUNK)? size : CHECKSUM_CHUNK;
+        size -= chunk;
+        state = __get_interrupt_state();
+        __disable_interrupt();
+        CRC32_setSeed(crc, CRC32_MODE);
+        for(; chunk > 1; chunk -= 2)
+            CRC32_set16BitData(*p++, CRC32_MODE);
+        if(chunk == 1)//odd trailing byte, only at the end of the data
+            CRC32_set8BitData(*(const uint8_t*)p, CRC32_MODE);
+        crc = CRC32_getResult(CRC32_MODE);
+        __set_interrupt_state(state);
+    }
+#endif
+    return crc;
+}
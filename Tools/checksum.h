@@ -0,0 +1,21 @@
+/*
+ * checksum.h
+ *
+ * Descriptions: CRC32 of data objects, computed by the CRC32 module or by software with CRCSOFTWARE
+ */
+
+#ifndef TOOLS_CHECKSUM_H_
+#define TOOLS_CHECKSUM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+#define CHECKSUM_CHUNK 64 //bytes fed to the CRC32 module in one critical section
+
+/*
+ * Compute the CRC32 of size bytes from data
+ */
+uint32_t checksum(const void* data, size_t size);
+
+#endif /* TOOLS_CHECKSUM_H_ */
@@ -0,0 +1,69 @@
+/*
+ * dmacopy.c
+ *
+ *  Descriptions: Implementation of the DMA copy engine
+ */
+
+#include <string.h>
+#include <driverlib.h>
+#include "dmacopy.h"
+
+/*
+ * description: configure the DMA controller for the copy engine
+ * parameters: none
+ * return: none
+ * note: should be called after every reset because the DMA registers are not preserved across power failures
+ * */
+void initDMAcopy()
+{
+    /* Do not interrupt the read-modify-write instructions, e.g., the switcher of the address maps */
+    DMA_disableTransferDuringReadModifyWrite();
+    DMA_disableInterrupt(DMACOPY_CHANNEL);
+}
+
+/*
+ * description: copy data with a block transfer of the DMA controller
+ * parameters: destination, source, size in terms of bytes
+ * return: the destination
+ * note: the CPU is halted during the block transfer, so the copy is done when this function returns.
+ *       The channel is shared by all tasks and interrupts, so it is programmed and triggered with interrupts disabled,
+ *       the interrupt state is restored instead of using the critical nesting as copies are also done in interrupts
+ * */
+void* DMAcopy(void* dst, const void* src, size_t size)
+{
+    DMA_initParam param = {0};
+    unsigned int odd = 0;
+    istate_t state;
+
+    if(size < DMACOPY_THRESHOLD)
+        return memcpy(dst, src, size);
+
+    param.channelSelect = DMACOPY_CHANNEL;
+    param.transferModeSelect = DMA_TRANSFER_BLOCK;
+    param.triggerSourceSelect = DMA_TRIGGERSOURCE_0;//software trigger by DMAREQ
+    param.triggerTypeSelect = DMA_TRIGGER_RISINGEDGE;
+    if((((uint32_t)dst | (uint32_t)src) & 1) == 0){//word transfers for aligned data
+        param.transferUnitSelect = DMA_SIZE_SRCWORD_DSTWORD;
+        param.transferSize = size >> 1;
+        odd = size & 1;
+    }
+    else{
+        param.transferUnitSelect = DMA_SIZE_SRCBYTE_DSTBYTE;
+        param.transferSize = size;
+    }
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    DMA_init(&param);
+    DMA_setSrcAddress(DMACOPY_CHANNEL, (uint32_t)src, DMA_DIRECTION_INCREMENT);
+    DMA_setDstAddress(DMACOPY_CHANNEL, (uint32_t)dst, DMA_DIRECTION_INCREMENT);
+    DMA_enableTransfers(DMACOPY_CHANNEL);
+    DMA_startTransfer(DMACOPY_CHANNEL);
+    __set_interrupt_state(state);
+
+    //the last byte of an odd size
+    if(odd)
+        ((uint8_t*)dst)[size-1] = ((const uint8_t*)src)[size-1];
+
+    return dst;
+}
@@ -0,0 +1,27 @@
+/*
+ * dmacopy.h
+ *
+ * Descriptions: Copy engine using the DMA controller for copies of data objects
+ * note: the data manager only copies to a version that is not published yet or to a working space in SRAM,
+ *       so a power failure in the middle of a transfer leaves no partially written data visible after recovery
+ */
+
+#ifndef TOOLS_DMACOPY_H_
+#define TOOLS_DMACOPY_H_
+
+#include <stddef.h>
+#include "config.h"
+
+#define DMACOPY_CHANNEL DMA_CHANNEL_0
+
+/*
+ * Configure the DMA controller for the copy engine
+ */
+void initDMAcopy();
+
+/*
+ * Copy size bytes from src to dst, DMA is used if size is no less than DMACOPY_THRESHOLD
+ */
+void* DMAcopy(void* dst, const void* src, size_t size);
+
+#endif /* TOOLS_DMACOPY_H_ */
@@ -5,6 +5,7 @@
  */
 
 #include "hwsetup.h"
+#include "dmacopy.h"
 
 /* we set the CPU frequency as 16 MHz by default */
 unsigned int FreqLevel = 8;
@@ -36,6 +37,18 @@ void initVDetector()
 }
 
 
+#ifdef DBPROFILE
+/*
+ * description: Initialize Timer B0 as a free-running SMCLK counter to profile the data manager
+ * parameters: none
+ * return: none
+ * */
+void initProfiler()
+{
+    TB0CTL = TBSSEL__SMCLK | MC__CONTINUOUS | TBCLR;
+}
+#endif
+
 /*
  * description: Initialize clocks and UART of the MSP430 board
  * parameters: none
@@ -72,6 +85,13 @@ void prvSetupHardware( void )
 
     /* Initialize UART */
     uartinit();
+
+    /* Initialize the DMA copy engine used by the data manager */
+    initDMAcopy();
+
+#ifdef DBPROFILE
+    initProfiler();
+#endif
 }
 
 /*
@@ -94,6 +114,13 @@ __interrupt void ADC12_ISR(void)
         ADC12IER2 |= ADC12LOIE;
         ADC12IFGR2 &= ~ADC12LOIFG;
         voltage = ABOVE;
+#ifdef DBCACHE
+        {
+            //cache the commits again
+            extern void DBcacheResume(void);
+            DBcacheResume();
+        }
+#endif
         break;
     case  ADC12IV_ADC12LOIFG:                  // Vector  8:  ADC12LO
         /* Disable the low side and enable the high side interrupt. */
@@ -101,6 +128,20 @@ __interrupt void ADC12_ISR(void)
         ADC12IER2 |= ADC12HIIE;
         ADC12IFGR2 &= ~ADC12HIIFG;
         voltage = BELOW;
+#ifdef GROUPCOMMIT
+        {
+            //publish the staged commits before the energy runs out
+            extern void DBpublish(void);
+            DBpublish();
+        }
+#endif
+#ifdef DBCACHE
+        {
+            //write the cached commits back before the energy runs out
+            extern void DBcacheFlush(void);
+            DBcacheFlush();
+        }
+#endif
         break;
     case ADC12IV_ADC12INIFG: break;           // Vector 10:  ADC12IN
     case ADC12IV_ADC12IFG0:                   // Vector 12:  ADC12MEM0
@@ -22,6 +22,13 @@ enum VOL{
  */
 void initVDetector();
 
+#ifdef DBPROFILE
+/*
+ * Configure the timer used to profile the data manager
+ */
+void initProfiler();
+#endif
+
 /*
  * Configure the hardware as necessary.
  */
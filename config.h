@@ -14,7 +14,42 @@
 #define DEBUGOVERFLOW //take it out for fast recovery
 
 #define NUMTASK 12 //10 user tasks + 2 FreeRTOS tasks
-#define MAXREAD 8
+#define NUMOBJ 16 //number of data objects, more than 16 objects use a multi-word mapSwitcher
+#define NUMVERSION 2 //number of versions kept for each object, more versions let readers be served older versions instead of aborting
+#define MAXCOMMIT 6 //maximum number of data objects committed atomically by one DBcommit
+//#define SHADOWSLOT //preallocate two versions for each object at creation, DBcommit then works without heap allocation
+#define DMACOPY_THRESHOLD 64 //data manager copies of at least this many bytes use DMA instead of memcpy
+#define MAXLEASE 4 //maximum number of read leases held at the same time
+#define MAXSNAPSHOT 8 //versions pinned by the snapshot reads of each task, kept apart from the MAXLEASE shared leases
+//#define DBSLAB //allocate the versions of DBcommit from a size-class allocator in FRAM instead of the heap, not used with SHADOWSLOT
+#define SLABSIZE 4096 //bytes of FRAM reserved for DBSLAB
+#define MAXLOG 2 //number of append-only log objects
+#define LOGSIZE 512 //bytes of each log object in FRAM, including a word of size for each record
+#define PAGESIZE 64 //bytes of each page of a paged array object, a page is the unit copied by DBwriteRange
+#define MAXPAGES 8 //maximum number of pages of a paged array object
+#define WORKSRAMSIZE 32 //bytes of the working arena in SRAM for each task
+#define WORKNVMSIZE 512 //bytes of the working arena in FRAM for each task, used for large working spaces
+//#define GROUPCOMMIT //validated commits are staged and published together at the next tick or at low voltage
+//#define DBEARLYABORT //validate the task switched in at each tick, a task which cannot commit anymore is rerun at its next data manager call
+//#define DBCOMPACT //relocate committed versions to lower heap addresses during idle time, not used with SHADOWSLOT or NUMVERSION > 2
+#define COMPACTBYTES 256 //maximum bytes relocated in each idle slice
+//#define DBCRC //each committed version carries a CRC32, the recently committed objects are verified after power failures
+//#define CRCSOFTWARE //compute the CRC32 by software instead of the CRC32 module
+#define CRCRECENT 8 //number of the latest commits verified by DBrecovery with DBCRC
+//#define DBELIDE //DBcommit skips the entries equal to their committed versions, compared by the CRC32 first with DBCRC
+//#define DBCOALESCE //with GROUPCOMMIT, a task committing the same objects again rewrites its unpublished versions in place
+#define COALESCEWINDOW 1 //ticks between the publishes of GROUPCOMMIT, longer windows coalesce more commits
+//#define DBRESUME //DBcommitLarge copies a large object in chunks, and DBrecovery resumes a copy cut by a power failure
+#define RESUMECHUNK 256 //bytes copied by DBcommitLarge between the updates of its cursor in FRAM
+#define RESUMECALLS 4 //large commits of a run whose ids are kept for its rerun, only these can create data
+//#define UNDOLOG //small commits overwrite the versions in place with an undo log of the task, instead of switching to new versions
+#define UNDOSIZE 128 //bytes of the undo log of each task, commits whose versions do not fit switch to new versions
+//#define DBCACHE //the most read objects are cached in SRAM, commits to them are written back at low voltage or before other commits
+#define CACHESIZE 256 //bytes of SRAM for the cached objects
+#define CACHEENTRIES 4 //maximum number of cached objects, at most MAXCOMMIT as they are written back by one switch, each keeps two spare versions in FRAM for it
+#define CACHEADMIT 4 //reads of an object since the last aging to be cached
+#define CACHEAGING 64 //reads between the halvings of the read counts
+//#define DBPROFILE //count the SMCLK cycles with interrupts disabled in the data manager, uses Timer B0
 
 //Used for demo
 #define IDIDLE 0
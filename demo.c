@@ -6,6 +6,7 @@
 #include <config.h>
 #include <TaskManager/taskManager.h>
 #include <DataManager/SimpDB.h>
+#include <DataManager/KeyDB.h>
 #include <demo.h>
 
 //matrix multiplication
@@ -36,7 +37,6 @@ const UInt16 m2[4][5] = {
     {0x0B, 0x0C, 0x0D, 0x0E, 0x0F},
     {0x10, 0x11, 0x12, 0x13, 0x14}
     };
-extern int DID0;
 /*
  * description: do matrix multiplication
  * parameters: none
@@ -69,10 +69,10 @@ void matrixmultiplication()
         }
         //commit the resultant value
         struct working data;
-        DBworking(&data, DID0);
+        DBworkingKey(&data, KEYMATMUL);
         unsigned long* ptr = data.address;
         *ptr = m3[progress%3][progress%5];
-        DID0 = DBcommit(&data,4,1); //4 byte, 1 data
+        DBput(KEYMATMUL, &data, 4); //4 byte
         progress++;
     }
 }
@@ -91,7 +91,6 @@ UInt32 div(UInt32 a, UInt32 b)
     return (a / b);
 }
 
-extern int DID1;
 /*
  * description: do 32 bit math operations
  * parameters: none
@@ -119,10 +118,10 @@ void math32()
             result32[3] = result32[1] / result32[2];
         }
         struct working data;
-        DBworking(&data, DID1);
+        DBworkingKey(&data, KEYMATH32);
         unsigned long* ptr = data.address;
         *ptr = result32[3];
-        DID1 = DBcommit(&data,4,1); //4 byte, 1 data
+        DBput(KEYMATH32, &data, 4); //4 byte
         progress++;
     }
 }
@@ -11,6 +11,10 @@
 #define ITERMATRIXMUL 10
 #define ITERMATH32 50
 
+//keys of the data objects
+#define KEYMATMUL 1
+#define KEYMATH32 2
+
 void demo();
 
 #endif /* DEMO_H_ */
@@ -15,6 +15,9 @@
 #include <Tools/hwsetup.h>
 #include <TaskManager/taskManager.h>
 #include <DataManager/SimpDB.h>
+#include <DataManager/KeyDB.h>
+#include <DataManager/LogDB.h>
+#include <DataManager/slab.h>
 #include <main.h>
 #include <demo.h>
 
@@ -29,11 +32,6 @@ int failCount;
 int lengthyFail;
 #pragma NOINIT(aboveFail)
 int aboveFail;
-//data id
-#pragma NOINIT(DID0)
-int DID0;
-#pragma NOINIT(DID1)
-int DID1;
 
 
 /*
@@ -50,10 +48,11 @@ void intializeLOGVar()
     lengthyFail = 0;
     aboveFail = 0;
     timeCounter = 0;
-    DID0 = -1;
-    DID1 = -1;
     resetTasks();//no task is created before
     constructor();//init data structures of data manager
+    initKeys();//init the key index of data manager
+    initLogs();//init the log objects of data manager
+    initSlab();//init the allocator for data versions
     pvInitHeapVar();//init variables for the NVM heap
     resetAllTasks();//all tasks are executed from the beginning
 }
@@ -93,6 +92,12 @@ int main( void )
 	    //low voltage detector
 	    initVDetector();
 
+	    //recover data structures of the data manager
+	    DBrecovery();
+
+	    //count the appends cut after their records were published
+	    recoverLogs();
+
 	    //recover all tasks
 	    failureRecovery();
 	}
@@ -56,6 +56,11 @@ void vApplicationStackOverflowHook( TaskHandle_t pxTask, char *pcTaskName )
 /* Can be used to implement background services */
 void vApplicationIdleHook( void )
 {
+#ifdef DBCOMPACT
+    //compact the data of the data manager before sleeping, a bounded amount in each idle slice
+    if(DBcompact(COMPACTBYTES) > 0)
+        return;
+#endif
     __bis_SR_register( LPM4_bits + GIE );
     __no_operation();
 }